@@ -11,10 +11,10 @@
  *   MAX72XX_7SEGMENT_DISPLAY - семисегментный экран на драйверах MAX7219 или
  *                              MAX7221, четыре цифры
  *   MAX72XX_MATRIX_DISPLAY   - матричный светодиодный экран на драйверах
- *                              MAX7219 или MAX7221, составленный из четырех
- *                              матриц 8х8
- *   WS2812_MATRIX_DISPLAY    - матричный светодиодный экран 8х32 на базе
- *                              адресных светодиодов
+ *                              MAX7219 или MAX7221, составленный из матриц
+ *                              8х8 (по умолчанию - из четырех)
+ *   WS2812_MATRIX_DISPLAY    - матричный светодиодный экран на базе адресных
+ *                              светодиодов (по умолчанию - 8х32)
  *   LCD_I2C_DISPLAY          - текстовый двух- (четырех-)строчный LCD экран,
  *                              подключаемый по I2C
  */
@@ -99,6 +99,9 @@ int8_t constexpr DISPLAY_CS_PIN = 10;  // пин для подключения 
  */
 #define MX_TYPE BY_COLUMNS
 
+// ---- сглаживание яркости ----------------
+// #define USE_BRIGHTNESS_DITHERING // временное сглаживание яркости: дробные значения яркости отрабатываются чередованием соседних уровней от кадра к кадру; при обновлении экрана реже 100 раз в секунду дает заметное мерцание
+
 // ---- цвет символов ----------------------
 #define COLOR_OF_NUMBER CRGB::Red
 
@@ -121,6 +124,10 @@ int8_t constexpr DISPLAY_CLK_PIN = -1; // пин для подключения 
 
 #if defined(MAX72XX_MATRIX_DISPLAY) || defined(WS2812_MATRIX_DISPLAY)
 
+// ---- размер матрицы ---------------------
+#define MATRIX_WIDTH 32 // количество столбцов матрицы (32 - стандартный экран 8х32, 64 - две панели по горизонтали); для MAX72xx - кратно 8
+#define MATRIX_HEIGHT 8 // количество строк матрицы (8 или 16 - две панели по вертикали); кратно 8
+
 // ---- Language ---------------------------
 #define USE_RU_LANGUAGE // использовать русский язык и символы кириллицы при выводе данных
 
@@ -134,6 +141,16 @@ uint8_t constexpr TICKER_SPEED = 100; // скорость бегущей стр
 
 #endif
 
+// ---- анимация смены цифр ----------------
+// #define USE_DIGIT_ANIMATION // анимировать смену цифр времени: прокрутка для MAX72xx, плавная смена цвета для адресных светодиодов
+
+#if defined(USE_DIGIT_ANIMATION)
+
+// ---- скорость анимации смены цифр, fps --
+uint8_t constexpr DIGIT_ANIMATION_SPEED = 25; // скорость смены кадров анимации в кадрах в секунду;
+
+#endif
+
 // ---- секундный столбик -------------------
 // #define SHOW_SECOND_COLUMN // показывать на правом краю экрана световой столбик, отображающий количество текущих секунд в минуте
 
@@ -266,6 +283,30 @@ int8_t constexpr NTC_PIN = A0;
 
 // #define USE_CLOCK_EVENT // использовать события часов - ежесекундное событие и событие будильника
 
+#define ADDITIONAL_TASK_COUNT 0 // количество пользовательских задач, добавляемых методом addAdditionalTask(); место под них в списке задач резервируется при компиляции
+
+#define ADDITIONAL_CRON_TASK_COUNT 0 // количество пользовательских задач по расписанию, добавляемых методом addCronTask()
+
+#define EVENT_QUEUE_SIZE 8 // размер очереди событий часов
+
+#define EVENT_HANDLER_COUNT 2 // количество пользовательских подписчиков на события, добавляемых методом addEventHandler()
+
+// #define USE_WATCHDOG // перезагружать часы сторожевым таймером, если опрос RTC, вывод на экран или другая контролируемая задача зависли (avr, esp32, rp2040)
+#if defined(USE_WATCHDOG)
+#define WATCHDOG_TIMEOUT 4000ul // время до перезагрузки, мс
+#define WATCHDOG_TASK_DEADLINE 2000 // срок, в течение которого контролируемая задача должна сработать, мс
+#endif
+
+// #define USE_TASK_TRACE // записывать время работы задач для анализа; содержимое выводится методом dumpTaskTrace()
+#if defined(USE_TASK_TRACE)
+#define TRACE_BUFFER_SIZE 64 // количество записей в буфере трассировки
+#endif
+
+// #define USE_DUAL_CORE // выводить изображение на матрицу из адресных светодиодов на втором ядре (esp32, rp2040)
+#if defined(USE_DUAL_CORE)
+// #define USE_SKETCH_LOOP1 // (rp2040) функции setup1() и loop1() определяет скетч, вывод на матрицу - вызов renderTick() из loop1()
+#endif
+
 #if defined(USE_LIGHT_SENSOR) || defined(USE_NTC)
 
 uint8_t constexpr BIT_DEPTH = 10; // разрядность АЦП используемого микроконтроллера; для Ардуино UNO, Nano, Pro Mini BIT_DEPTH = 10
@@ -274,6 +315,8 @@ uint8_t constexpr BIT_DEPTH = 10; // разрядность АЦП исполь
 
 // ==== настройки EEPROM =============================
 
+#define SETTINGS_HEADER_EEPROM_INDEX 92 // индекс ячейки в EEPROM для сохранения заголовка блока настроек - версии схемы и контрольной суммы (uint8_t x 2)
+
 #if defined(SHOW_SECOND_COLUMN)
 #define SECOND_COLUMN_ON_OF_DATA_EEPROM_INDEX 94 // индекс ячейки в EEPROM для сохранения статуса секундного столбца
 #endif
@@ -296,6 +339,12 @@ uint8_t constexpr BIT_DEPTH = 10; // разрядность АЦП исполь
 #define COLOR_OF_BACKGROUND_VALUE_EEPROM_INDEX 107 // индекс ячейки в EEPROM для сохранения цвета фона для экранов на адресных светодиодах (uint8_t x 4)
 #endif
 
+// #define USE_SETTINGS_LOG // хранить настройки не по фиксированным адресам, а в журнале с равномерным износом ячеек EEPROM; только для AVR, на остальных контроллерах игнорируется
+#if defined(USE_SETTINGS_LOG)
+#define SETTINGS_LOG_START_INDEX 112 // индекс первой ячейки области EEPROM, отведенной под журнал настроек
+#define SETTINGS_LOG_SIZE 256        // размер области журнала настроек, байт; чем больше область, тем медленнее изнашиваются ее ячейки
+#endif
+
 // ==== модуль RTC ===================================
 /*
  * здесь укажите используемый вами модуль часов реального времени;
@@ -304,11 +353,25 @@ uint8_t constexpr BIT_DEPTH = 10; // разрядность АЦП исполь
  *   RTC_DS1307 - модуль DS1307
  *   RTC_PCF8523 - модуль PCF8523
  *   RTC_PCF8563 - модуль PCF8563
+ *   RTC_AUTO_DETECT - определять модуль при старте по ответу на шине I2C
+ *     (0x51 - PCF8563, 0x68 - DS3231, DS1307 или PCF8523); удобно, если
+ *     прошивка одна для часов с разными модулями, но занимает больше памяти
  */
 #define RTC_DS3231
 
+// #define USE_RTC_CALIBRATION // калибровка хода RTC по эталонному времени, передаваемому методом syncTime()
+#if defined(USE_RTC_CALIBRATION) && (defined(RTC_DS1307) || defined(RTC_PCF8563) || defined(RTC_AUTO_DETECT))
+#define RTC_DRIFT_EEPROM_INDEX 90 // индекс ячейки в EEPROM для сохранения программной поправки хода RTC (uint16_t); для DS3231 и PCF8523 поправка хранится в самом модуле
+#endif
+
 // ---- модуль RTC - пины -----------------------
 #define RTC_SDA_PIN A4 // пин для подключения вывода SDA RTC модуля (для Atmega168/328 не менять!!!)
 #define RTC_SCL_PIN A5 // пин для подключения вывода SCL RTC модуля (для Atmega168/328 не менять!!!)
 
+// ---- модуль RTC - часовой пояс ---------------
+// #define USE_TIME_ZONE // хранить в RTC время UTC, а показывать местное время с учетом часового пояса и перехода на летнее время
+#if defined(USE_TIME_ZONE)
+#define TIME_ZONE_RULE "CET-1CEST,M3.5.0,M10.5.0/3" // правило часового пояса в формате POSIX TZ; например, "MSK-3" - Москва, "EST5EDT,M3.2.0,M11.1.0" - Нью-Йорк
+#endif
+
 // ==== конец настроек часов =========================
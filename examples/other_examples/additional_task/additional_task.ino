@@ -7,8 +7,8 @@
  * 
  *        Для добавления пользовательских задач нужно указать диспетчеру, 
  *        сколько дополнительных задач вы будете использовать; для этого 
- *        используется метод setAdditionalTaskCount(), который ОБЯЗАТЕЛЬНО
- *        должен быть вызван ПЕРЕД инициализацией часов.
+ *        служит опция ADDITIONAL_TASK_COUNT в файле clockSetting.h - место
+ *        под задачи резервируется при компиляции.
  * 
  *        После инициализации часов нужно добавить задачи в список; для этого
  *        используется метод addAdditionalTask() с указанием параметров задачи.
@@ -18,8 +18,8 @@
  *        сама останавливается через три минуты (180 срабатываний с интервалом
  *        в одну секунду).
  * 
- * @version 1.1
- * @date 2026-06-18
+ * @version 1.2
+ * @date 2026-10-19
  * 
  * @copyright Copyright (c) 2026
  * 
@@ -53,9 +53,6 @@ void setup()
 {
   Serial.begin(115200);
 
-  // увеличиваем список задач на одну дополнительную задачу; 
-  // вызывать ПЕРЕД методом init()
-  simple_clock.setAdditionalTaskCount(1);
   // инициализируем часы
   simple_clock.init();
   // подключаем дополнительную задачу; выполнять ПОСЛЕ вызова метода init()
@@ -289,6 +289,10 @@ int8_t constexpr NTC_PIN = A0;
 
 // #define USE_CLOCK_EVENT // использовать события часов - ежесекундное событие и событие будильника
 
+#define ADDITIONAL_TASK_COUNT 1 // количество пользовательских задач, добавляемых методом addAdditionalTask(); место под них в списке задач резервируется при компиляции
+
+#define ADDITIONAL_CRON_TASK_COUNT 0 // количество пользовательских задач по расписанию, добавляемых методом addCronTask()
+
 #if defined(USE_LIGHT_SENSOR) || defined(USE_NTC)
 
 uint8_t constexpr BIT_DEPTH = 10; // разрядность АЦП используемого микроконтроллера; для Ардуино UNO, Nano, Pro Mini BIT_DEPTH = 10
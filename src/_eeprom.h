@@ -3,85 +3,736 @@
 #include <EEPROM.h>
 #if defined(WS2812_MATRIX_DISPLAY)
 #include <FastLED.h>
-#define CRGB_UPDATE_DATA 0x7F
 #endif
+#define CRGB_UPDATE_DATA 0x7F // ячейка обновления цвета: значение, означающее, что цвет записан
+
+#if !defined(SETTINGS_HEADER_EEPROM_INDEX)
+#define SETTINGS_HEADER_EEPROM_INDEX 92
+#endif
+#if __USE_RTC_SOFT_CALIBRATION__ && !defined(RTC_DRIFT_EEPROM_INDEX)
+#define RTC_DRIFT_EEPROM_INDEX 90
+#endif
+
+// ==== кэш настроек в RAM ===========================
+
+/*
+ * все настройки часов, сохраняемые в EEPROM, при старте один раз считываются
+ * в структуру clkSettingsData (settings_load()), после чего чтение настроек
+ * выполняется только из RAM, прямо из полей структуры, без перебора схемы
+ * (settings_field()); запись выполняется и в структуру, и в EEPROM;
+ * ячейки EEPROM, не входящие в список настроек, читаются напрямую из EEPROM;
+ * при использовании опции USE_SETTINGS_LOG (только AVR) настройки хранятся не
+ * по своим индексам, а в журнале (см. clkSettingsLog.h)
+ *
+ * список настроек settings_items[] одновременно является схемой настроек:
+ * для каждого параметра задан допустимый диапазон значений и значение по
+ * умолчанию; перед блоком настроек хранится заголовок - версия схемы и
+ * контрольная сумма всего блока; чтобы не изнашивать ее ячейку, контрольная
+ * сумма записывается не при каждом изменении, а при выходе из режима настроек
+ * и при записи буфера EEPROM во флеш (settings_flush()); если питание
+ * пропало раньше, при старте просто будет выполнена поштучная проверка
+ * (в журнале настроек контрольная сумма попадает только в снимок при
+ * уплотнении, т.к. каждая запись журнала и так защищена своей CRC);
+ * при старте достаточно сверить версию и контрольную сумму, и только если
+ * они не совпали, выполняется миграция и поштучная проверка параметров
+ * (settings_check())
+ */
+
+uint8_t constexpr SETTINGS_SCHEMA_VERSION = 1; // версия схемы настроек; увеличивается при изменении состава или формата параметров
+
+struct clkSettingsData
+{
+  uint8_t schema_version; // версия схемы настроек
+  uint8_t schema_crc;     // контрольная сумма блока настроек (всех полей после заголовка)
+#if defined(SECOND_COLUMN_ON_OF_DATA_EEPROM_INDEX)
+  uint8_t second_column; // статус секундного столбика
+#endif
+#if defined(LIGHT_THRESHOLD_EEPROM_INDEX)
+  uint8_t light_threshold; // порог переключения яркости
+#endif
+#if defined(INTERVAL_FOR_AUTOSHOWDATA_EEPROM_INDEX)
+  uint8_t auto_show_interval; // периодичность автопоказа даты и температуры
+#endif
+#if defined(TICKER_STATE_VALUE_EEPROM_INDEX)
+  uint8_t ticker_state; // статус анимации
+#endif
+#if defined(MIN_BRIGHTNESS_VALUE_EEPROM_INDEX)
+  uint8_t min_brightness; // минимальная яркость экрана
+#endif
+#if defined(MAX_BRIGHTNESS_VALUE_EEPROM_INDEX)
+  uint8_t max_brightness; // максимальная яркость экрана
+#endif
+#if defined(ALARM_DATA_EEPROM_INDEX)
+  uint8_t alarm_state;    // состояние будильника
+  uint8_t alarm_point[2]; // точка срабатывания будильника, uint16_t; хранится побайтно, чтобы не зависеть от выравнивания
+#endif
+#if defined(COLOR_OF_NUMBER_VALUE_EEPROM_INDEX)
+  uint8_t color_of_number[4]; // цвет символов - ячейка обновления + r, g, b
+#endif
+#if defined(COLOR_OF_BACKGROUND_VALUE_EEPROM_INDEX)
+  uint8_t color_of_background[4]; // цвет фона - ячейка обновления + r, g, b
+#endif
+#if defined(RTC_DRIFT_EEPROM_INDEX)
+  uint8_t rtc_drift[2]; // программная поправка хода RTC, uint16_t; 0.01 ppm со смещением 32768
+#endif
+};
+
+struct clkSettingItem
+{
+  uint16_t index;     // индекс параметра в EEPROM
+  uint8_t offset;     // смещение параметра в структуре clkSettingsData
+  uint8_t size;       // размер параметра: 1 - uint8_t, 2 - uint16_t, 4 - цвет (четыре ячейки по одному байту)
+  uint16_t min_value; // минимальное допустимое значение; для цвета 1 означает, что черный цвет недопустим
+  uint16_t max_value; // максимальное допустимое значение
+  uint32_t def_value; // значение по умолчанию; для цвета - 0xRRGGBB
+};
+
+// допустимые уровни яркости экрана и значения по умолчанию для максимальной и минимальной яркости
+#if defined(MAX72XX_7SEGMENT_DISPLAY) || defined(MAX72XX_MATRIX_DISPLAY)
+#define __BRIGHTNESS_SCHEMA__ 0, 15
+#define __BRIGHTNESS_MAX_DEF__ 8
+#define __BRIGHTNESS_MIN_DEF__ 0
+#elif defined(WS2812_MATRIX_DISPLAY)
+#define __BRIGHTNESS_SCHEMA__ 1, 25
+#define __BRIGHTNESS_MAX_DEF__ 15
+#define __BRIGHTNESS_MIN_DEF__ 1
+#elif defined(LCD_I2C_DISPLAY)
+// яркость экранов LCD не регулируется
+#define __BRIGHTNESS_SCHEMA__ 0, 255
+#define __BRIGHTNESS_MAX_DEF__ 255
+#define __BRIGHTNESS_MIN_DEF__ 0
+#else
+#define __BRIGHTNESS_SCHEMA__ 1, 7
+#define __BRIGHTNESS_MAX_DEF__ 7
+#define __BRIGHTNESS_MIN_DEF__ 1
+#endif
+
+static const clkSettingItem PROGMEM settings_items[] = {
+    // заголовок блока настроек
+    {SETTINGS_HEADER_EEPROM_INDEX, offsetof(clkSettingsData, schema_version), 1, 0, 255, 0},
+    {SETTINGS_HEADER_EEPROM_INDEX + 1, offsetof(clkSettingsData, schema_crc), 1, 0, 255, 0},
+#if defined(SECOND_COLUMN_ON_OF_DATA_EEPROM_INDEX)
+    {SECOND_COLUMN_ON_OF_DATA_EEPROM_INDEX, offsetof(clkSettingsData, second_column), 1, 0, 1, 0},
+#endif
+#if defined(LIGHT_THRESHOLD_EEPROM_INDEX)
+    {LIGHT_THRESHOLD_EEPROM_INDEX, offsetof(clkSettingsData, light_threshold), 1, 1, 9, 3},
+#endif
+#if defined(INTERVAL_FOR_AUTOSHOWDATA_EEPROM_INDEX)
+    {INTERVAL_FOR_AUTOSHOWDATA_EEPROM_INDEX, offsetof(clkSettingsData, auto_show_interval), 1, 0, 7, 1},
+#endif
+#if defined(TICKER_STATE_VALUE_EEPROM_INDEX)
+    {TICKER_STATE_VALUE_EEPROM_INDEX, offsetof(clkSettingsData, ticker_state), 1, 0, 1, 1},
+#endif
+#if defined(MIN_BRIGHTNESS_VALUE_EEPROM_INDEX)
+    {MIN_BRIGHTNESS_VALUE_EEPROM_INDEX, offsetof(clkSettingsData, min_brightness), 1, __BRIGHTNESS_SCHEMA__, __BRIGHTNESS_MIN_DEF__},
+#endif
+#if defined(MAX_BRIGHTNESS_VALUE_EEPROM_INDEX)
+    {MAX_BRIGHTNESS_VALUE_EEPROM_INDEX, offsetof(clkSettingsData, max_brightness), 1, __BRIGHTNESS_SCHEMA__, __BRIGHTNESS_MAX_DEF__},
+#endif
+#if defined(ALARM_DATA_EEPROM_INDEX)
+    // смещения соответствуют ALARM_STATE и ALARM_POINT из clkAlarmClass.h; точка срабатывания - минуты от полуночи, по умолчанию 6:00
+    {ALARM_DATA_EEPROM_INDEX, offsetof(clkSettingsData, alarm_state), 1, 0, 1, 0},
+    {ALARM_DATA_EEPROM_INDEX + 1, offsetof(clkSettingsData, alarm_point), 2, 0, 1439, 360},
+#endif
+#if defined(COLOR_OF_NUMBER_VALUE_EEPROM_INDEX)
+    {COLOR_OF_NUMBER_VALUE_EEPROM_INDEX, offsetof(clkSettingsData, color_of_number), 4, 1, 0, (uint32_t)COLOR_OF_NUMBER},
+#endif
+#if defined(COLOR_OF_BACKGROUND_VALUE_EEPROM_INDEX)
+    {COLOR_OF_BACKGROUND_VALUE_EEPROM_INDEX, offsetof(clkSettingsData, color_of_background), 4, 0, 0, (uint32_t)COLOR_OF_BACKGROUND},
+#endif
+#if defined(RTC_DRIFT_EEPROM_INDEX)
+    {RTC_DRIFT_EEPROM_INDEX, offsetof(clkSettingsData, rtc_drift), 2, 0, 65535, 32768},
+#endif
+};
+
+uint8_t constexpr SETTINGS_ITEM_COUNT = sizeof(settings_items) / sizeof(clkSettingItem);
+
+clkSettingsData clk_settings;
+bool clk_settings_loaded = false;
+
+/**
+ * @brief поиск параметра в кэше настроек по схеме настроек; используется при записи, т.к. вместе с адресом возвращает описание параметра
+ *
+ * @param _index индекс ячейки EEPROM
+ * @param _size размер читаемых/записываемых данных: 1 или 2 байта
+ * @param _item если не nullptr, сюда записывается описание найденного параметра
+ * @return указатель на данные в кэше или nullptr, если ячейка не входит в список настроек или кэш еще не загружен
+ */
+uint8_t *settings_find(uint16_t _index, uint8_t _size, clkSettingItem *_item = nullptr)
+{
+  if (clk_settings_loaded)
+  {
+    for (uint8_t i = 0; i < SETTINGS_ITEM_COUNT; i++)
+    {
+      clkSettingItem item;
+      memcpy_P(&item, &settings_items[i], sizeof(clkSettingItem));
+      if ((item.size == 4 && _size == 1 &&
+           _index >= item.index && _index < item.index + 4) ||
+          (item.size == _size && _index == item.index))
+      {
+        if (_item != nullptr)
+        {
+          *_item = item;
+        }
+        return ((uint8_t *)&clk_settings + item.offset + (_index - item.index));
+      }
+    }
+  }
+  return (nullptr);
+}
+
+/**
+ * @brief адрес параметра в кэше настроек для чтения
+ *
+ * в отличие от settings_find() не перебирает схему настроек во флеш, а сразу
+ * переходит к полю структуры по индексу ячейки; используется для чтения
+ * настроек, которые опрашиваются постоянно (яркость, секундный столбик и т.д.);
+ * список должен соответствовать settings_items[]
+ *
+ * @param _index индекс ячейки EEPROM
+ * @return указатель на данные в кэше или nullptr, если ячейка не входит в список настроек или кэш еще не загружен
+ */
+uint8_t *settings_field(uint16_t _index)
+{
+  if (!clk_settings_loaded)
+  {
+    return (nullptr);
+  }
+
+  uint8_t *p = nullptr;
+  switch (_index)
+  {
+  case SETTINGS_HEADER_EEPROM_INDEX:
+    p = &clk_settings.schema_version;
+    break;
+  case SETTINGS_HEADER_EEPROM_INDEX + 1:
+    p = &clk_settings.schema_crc;
+    break;
+#if defined(SECOND_COLUMN_ON_OF_DATA_EEPROM_INDEX)
+  case SECOND_COLUMN_ON_OF_DATA_EEPROM_INDEX:
+    p = &clk_settings.second_column;
+    break;
+#endif
+#if defined(LIGHT_THRESHOLD_EEPROM_INDEX)
+  case LIGHT_THRESHOLD_EEPROM_INDEX:
+    p = &clk_settings.light_threshold;
+    break;
+#endif
+#if defined(INTERVAL_FOR_AUTOSHOWDATA_EEPROM_INDEX)
+  case INTERVAL_FOR_AUTOSHOWDATA_EEPROM_INDEX:
+    p = &clk_settings.auto_show_interval;
+    break;
+#endif
+#if defined(TICKER_STATE_VALUE_EEPROM_INDEX)
+  case TICKER_STATE_VALUE_EEPROM_INDEX:
+    p = &clk_settings.ticker_state;
+    break;
+#endif
+#if defined(MIN_BRIGHTNESS_VALUE_EEPROM_INDEX)
+  case MIN_BRIGHTNESS_VALUE_EEPROM_INDEX:
+    p = &clk_settings.min_brightness;
+    break;
+#endif
+#if defined(MAX_BRIGHTNESS_VALUE_EEPROM_INDEX)
+  case MAX_BRIGHTNESS_VALUE_EEPROM_INDEX:
+    p = &clk_settings.max_brightness;
+    break;
+#endif
+#if defined(ALARM_DATA_EEPROM_INDEX)
+  case ALARM_DATA_EEPROM_INDEX:
+    p = &clk_settings.alarm_state;
+    break;
+  case ALARM_DATA_EEPROM_INDEX + 1:
+    p = clk_settings.alarm_point;
+    break;
+#endif
+#if defined(COLOR_OF_NUMBER_VALUE_EEPROM_INDEX)
+  case COLOR_OF_NUMBER_VALUE_EEPROM_INDEX:
+  case COLOR_OF_NUMBER_VALUE_EEPROM_INDEX + 1:
+  case COLOR_OF_NUMBER_VALUE_EEPROM_INDEX + 2:
+  case COLOR_OF_NUMBER_VALUE_EEPROM_INDEX + 3:
+    p = clk_settings.color_of_number + (_index - COLOR_OF_NUMBER_VALUE_EEPROM_INDEX);
+    break;
+#endif
+#if defined(COLOR_OF_BACKGROUND_VALUE_EEPROM_INDEX)
+  case COLOR_OF_BACKGROUND_VALUE_EEPROM_INDEX:
+  case COLOR_OF_BACKGROUND_VALUE_EEPROM_INDEX + 1:
+  case COLOR_OF_BACKGROUND_VALUE_EEPROM_INDEX + 2:
+  case COLOR_OF_BACKGROUND_VALUE_EEPROM_INDEX + 3:
+    p = clk_settings.color_of_background + (_index - COLOR_OF_BACKGROUND_VALUE_EEPROM_INDEX);
+    break;
+#endif
+#if defined(RTC_DRIFT_EEPROM_INDEX)
+  case RTC_DRIFT_EEPROM_INDEX:
+    p = clk_settings.rtc_drift;
+    break;
+#endif
+  default:
+    break;
+  }
+  return (p);
+}
 
 // ===================================================
 
-#if __USE_EEPROM_IN_FLASH__
-void eeprom_update(uint16_t _index, uint8_t _data)
+#if __USE_EEPROM_WRITE_BEHIND__
+/*
+ * отложенная запись: на контроллерах, где EEPROM эмулируется во флеш-памяти,
+ * изменения сначала накапливаются в буфере EEPROM, а во флеш записываются
+ * одним пакетом - после паузы в изменениях настроек (EEPROM_COMMIT_DELAY),
+ * при выходе из режима настроек или по вызову eeprom_flush(); таким образом
+ * сектор флеш-памяти стирается один раз на все изменения, а не на каждый байт
+ */
+uint16_t constexpr EEPROM_COMMIT_DELAY = 3000; // пауза после последнего изменения, по истечении которой буфер записывается во флеш, мс
+
+bool eeprom_dirty = false;       // в буфере есть не записанные во флеш изменения
+uint32_t eeprom_dirty_timer = 0; // время последнего изменения
+
+void settings_seal();
+
+/**
+ * @brief запись буфера EEPROM во флеш, если в нем есть изменения
+ *
+ */
+void eeprom_flush()
 {
-  if (EEPROM.read(_index) != _data)
+  // контрольная сумма настроек попадает во флеш тем же пакетом
+  settings_seal();
+  if (eeprom_dirty)
   {
-    EEPROM.write(_index, _data);
+#if defined(ARDUINO_ARCH_STM32)
+    eeprom_buffer_flush();
+#else
     EEPROM.commit();
+#endif
+    eeprom_dirty = false;
+  }
+}
+
+/**
+ * @brief запись буфера EEPROM во флеш, если с момента последнего изменения прошло не менее EEPROM_COMMIT_DELAY мс
+ *
+ */
+void eeprom_tick()
+{
+  if (eeprom_dirty && (millis() - eeprom_dirty_timer >= EEPROM_COMMIT_DELAY))
+  {
+    eeprom_flush();
   }
 }
 #endif
 
-uint8_t read_eeprom_8(uint16_t _index)
+uint8_t eeprom_read(uint16_t _index)
 {
-  uint8_t result = EEPROM.read(_index);
-  return result;
+#if defined(ARDUINO_ARCH_STM32)
+  // EEPROM.read() под stm32duino каждый раз перечитывает буфер из флеш, теряя не записанные изменения
+  return (eeprom_buffered_read_byte(_index));
+#else
+  return (EEPROM.read(_index));
+#endif
 }
 
-uint16_t read_eeprom_16(uint16_t _index)
+void eeprom_update(uint16_t _index, uint8_t _data)
 {
-  uint16_t _data;
+#if __USE_EEPROM_WRITE_BEHIND__
+  if (eeprom_read(_index) != _data)
+  {
+#if defined(ARDUINO_ARCH_STM32)
+    eeprom_buffered_write_byte(_index, _data);
+#else
+    EEPROM.write(_index, _data);
+#endif
+    eeprom_dirty = true;
+    eeprom_dirty_timer = millis();
+  }
+#else
+  EEPROM.update(_index, _data);
+#endif
+}
 
+uint16_t eeprom_read_16(uint16_t _index)
+{
+  uint16_t _data;
 #if defined(__STM32F1__)
   _data = EEPROM.read(_index);
+#elif defined(ARDUINO_ARCH_STM32)
+  _data = eeprom_read(_index) | (eeprom_read(_index + 1) << 8);
 #else
   EEPROM.get(_index, _data);
 #endif
   return (_data);
 }
 
-// TODO: для stm32f4 под stm32duino наблюдается довольно длительная запись в EEPROM
-
-void write_eeprom_8(uint16_t _index, uint8_t _data)
+void eeprom_update_16(uint16_t _index, uint16_t _data)
 {
-#if __USE_EEPROM_IN_FLASH__
-  eeprom_update(_index, _data);
-#else
+#if defined(__STM32F1__)
   EEPROM.update(_index, _data);
+#elif __USE_EEPROM_WRITE_BEHIND__
+  // побайтно, младшим байтом вперед - как и EEPROM.put(); неизменившиеся байты не пишутся
+  eeprom_update(_index, lowByte(_data));
+  eeprom_update(_index + 1, highByte(_data));
+#else
+  EEPROM.put(_index, _data);
 #endif
 }
-void write_eeprom_16(uint16_t _index, uint16_t _data)
+
+/**
+ * @brief пошаговый расчет CRC8 (полином Dallas/Maxim)
+ *
+ * @param crc текущее значение CRC
+ * @param data очередной байт данных
+ * @return uint8_t
+ */
+uint8_t settings_crc8(uint8_t crc, uint8_t data)
 {
-#if defined(__STM32F1__)
-  EEPROM.update(_index, _data);
+  crc ^= data;
+  for (uint8_t i = 0; i < 8; i++)
+  {
+    crc = (crc & 0x01) ? (crc >> 1) ^ 0x8C : (crc >> 1);
+  }
+  return (crc);
+}
+
+#if __USE_SETTINGS_LOG__
+#include "clkSettingsLog.h"
+#endif
+
+/**
+ * @brief сохранение параметра из кэша настроек в EEPROM (или в журнал настроек)
+ *
+ * @param _item описание параметра
+ */
+void settings_store(clkSettingItem &_item)
+{
+#if __USE_SETTINGS_LOG__
+  clkSetLog.append(_item);
 #else
-  EEPROM.put(_index, _data);
+  uint8_t *p = (uint8_t *)&clk_settings + _item.offset;
+  if (_item.size == 2)
+  {
+    uint16_t x;
+    memcpy(&x, p, 2);
+    eeprom_update_16(_item.index, x);
+  }
+  else
+  {
+    for (uint8_t i = 0; i < _item.size; i++)
+    {
+      eeprom_update(_item.index + i, p[i]);
+    }
+  }
 #endif
+}
+
+/**
+ * @brief контрольная сумма блока настроек - всех полей clkSettingsData после заголовка
+ *
+ * @return uint8_t
+ */
+uint8_t settings_checksum()
+{
+  uint8_t crc = 0;
+  uint8_t *p = (uint8_t *)&clk_settings;
+  for (uint8_t i = offsetof(clkSettingsData, schema_crc) + 1; i < sizeof(clkSettingsData); i++)
+  {
+    crc = settings_crc8(crc, p[i]);
+  }
+  return (crc);
+}
+
+bool settings_unsealed = false; // контрольная сумма в заголовке не учитывает последние изменения настроек
 
-#if __USE_EEPROM_IN_FLASH__
-  EEPROM.commit();
+/**
+ * @brief обновление контрольной суммы блока настроек в заголовке, если настройки менялись
+ *
+ */
+void settings_seal()
+{
+  if (!settings_unsealed)
+  {
+    return;
+  }
+
+  settings_unsealed = false;
+  uint8_t crc = settings_checksum();
+  if (clk_settings.schema_crc != crc)
+  {
+    clk_settings.schema_crc = crc;
+#if !__USE_SETTINGS_LOG__
+    // в журнал контрольная сумма отдельной записью не пишется - она попадает в снимок при уплотнении
+    clkSettingItem item;
+    memcpy_P(&item, &settings_items[1], sizeof(clkSettingItem));
+    settings_store(item);
 #endif
+  }
+}
+
+/**
+ * @brief отметка об изменении настроек; в журнале контрольная сумма обновляется сразу, т.к. пишется только в кэш
+ *
+ */
+void settings_changed()
+{
+  settings_unsealed = true;
+#if __USE_SETTINGS_LOG__
+  settings_seal();
+#endif
+}
+
+/**
+ * @brief приведение значения параметра в кэше к допустимому, если это необходимо
+ *
+ * @param _item описание параметра
+ * @param _force если true, параметру присваивается значение по умолчанию без проверки
+ * @return true, если значение параметра было изменено
+ */
+bool settings_repair(clkSettingItem &_item, bool _force = false)
+{
+  uint8_t *p = (uint8_t *)&clk_settings + _item.offset;
+  if (_item.size == 4)
+  {
+    // цвет: ячейка обновления + r, g, b; если не записана ячейка обновления или задан недопустимый черный цвет, задать цвет по умолчанию
+    if (!_force && p[0] == CRGB_UPDATE_DATA &&
+        !(_item.min_value && p[1] == 0x00 && p[2] == 0x00 && p[3] == 0x00))
+    {
+      return (false);
+    }
+    p[0] = CRGB_UPDATE_DATA;
+    p[1] = (uint8_t)(_item.def_value >> 16);
+    p[2] = (uint8_t)(_item.def_value >> 8);
+    p[3] = (uint8_t)_item.def_value;
+    return (true);
+  }
+
+  uint16_t x = p[0];
+  if (_item.size == 2)
+  {
+    memcpy(&x, p, 2);
+  }
+  if (!_force && x >= _item.min_value && x <= _item.max_value)
+  {
+    return (false);
+  }
+  x = (uint16_t)_item.def_value;
+  memcpy(p, &x, _item.size);
+  return (true);
+}
+
+/**
+ * @brief перенос настроек, сохраненных по схеме предыдущей версии
+ *
+ * @param _from версия схемы, по которой были сохранены настройки
+ */
+void settings_migrate(uint8_t _from)
+{
+  switch (_from)
+  {
+  case SETTINGS_SCHEMA_VERSION:
+    // схема та же, не совпала только контрольная сумма - достаточно поштучной проверки
+    break;
+  default:
+    /*
+     * настройки сохранены до появления схемы (заголовок не записан): индексы
+     * и форматы параметров в версии 1 те же, поэтому значения, в т.ч.
+     * настройки будильника и цвета, сохраняются как есть и только проверяются
+     * на допустимость; при изменении схемы здесь для каждой из предыдущих
+     * версий добавляется case с переносом параметров на новые места
+     */
+    break;
+  }
+}
+
+/**
+ * @brief проверка настроек при старте; если версия схемы или контрольная сумма не совпали, выполняется миграция и поштучная проверка параметров с заменой недопустимых значений значениями по умолчанию
+ *
+ */
+void settings_check()
+{
+  if (clk_settings.schema_version == SETTINGS_SCHEMA_VERSION &&
+      clk_settings.schema_crc == settings_checksum())
+  {
+    return;
+  }
+
+  settings_migrate(clk_settings.schema_version);
+
+  for (uint8_t i = 0; i < SETTINGS_ITEM_COUNT; i++)
+  {
+    clkSettingItem item;
+    memcpy_P(&item, &settings_items[i], sizeof(clkSettingItem));
+    if (settings_repair(item))
+    {
+      settings_store(item);
+    }
+  }
+
+  if (clk_settings.schema_version != SETTINGS_SCHEMA_VERSION)
+  {
+    clk_settings.schema_version = SETTINGS_SCHEMA_VERSION;
+    clkSettingItem item;
+    memcpy_P(&item, &settings_items[0], sizeof(clkSettingItem));
+    settings_store(item);
+  }
+  settings_unsealed = true;
+  settings_seal();
+}
+
+uint8_t read_eeprom_8(uint16_t _index)
+{
+  uint8_t *p = settings_field(_index);
+  if (p != nullptr)
+  {
+    return (*p);
+  }
+
+  uint8_t result = eeprom_read(_index);
+  return result;
+}
+
+uint16_t read_eeprom_16(uint16_t _index)
+{
+  uint8_t *p = settings_field(_index);
+  if (p != nullptr)
+  {
+    uint16_t _data;
+    memcpy(&_data, p, 2);
+    return (_data);
+  }
+
+  return (eeprom_read_16(_index));
+}
+
+void write_eeprom_8(uint16_t _index, uint8_t _data)
+{
+  clkSettingItem item;
+  uint8_t *p = settings_find(_index, 1, &item);
+  if (p != nullptr)
+  {
+    if (*p != _data) // данные не изменились - в EEPROM лезть незачем
+    {
+      *p = _data;
+      settings_repair(item); // недопустимое значение заменяется значением по умолчанию
+      settings_store(item);
+      settings_changed();
+    }
+    return;
+  }
+
+  eeprom_update(_index, _data);
+}
+
+void write_eeprom_16(uint16_t _index, uint16_t _data)
+{
+  clkSettingItem item;
+  uint8_t *p = settings_find(_index, 2, &item);
+  if (p != nullptr)
+  {
+    if (memcmp(p, &_data, 2) != 0)
+    {
+      memcpy(p, &_data, 2);
+      settings_repair(item); // недопустимое значение заменяется значением по умолчанию
+      settings_store(item);
+      settings_changed();
+    }
+    return;
+  }
+
+  eeprom_update_16(_index, _data);
 }
 
 #if defined(WS2812_MATRIX_DISPLAY)
 void read_eeprom_crgb(uint16_t _index, CRGB &_color)
 {
-  _color.r = EEPROM.read(_index + 1);
-  _color.g = EEPROM.read(_index + 2);
-  _color.b = EEPROM.read(_index + 3);
+  _color.r = read_eeprom_8(_index + 1);
+  _color.g = read_eeprom_8(_index + 2);
+  _color.b = read_eeprom_8(_index + 3);
 }
 
 void write_eeprom_crgb(uint16_t _index, CRGB _color)
 {
-#if __USE_EEPROM_IN_FLASH__
-  eeprom_update(_index + 1, _color.r);
-  eeprom_update(_index + 2, _color.g);
-  eeprom_update(_index + 3, _color.b);
-  eeprom_update(_index, CRGB_UPDATE_DATA);
+  // цвет сохраняется одной операцией, а не четырьмя
+  clkSettingItem item;
+  uint8_t *p = settings_find(_index, 1, &item);
+  if (p != nullptr)
+  {
+    uint8_t x[4] = {CRGB_UPDATE_DATA, _color.r, _color.g, _color.b};
+    if (memcmp(p, x, 4) != 0)
+    {
+      memcpy(p, x, 4);
+      settings_repair(item); // недопустимое значение заменяется значением по умолчанию
+      settings_store(item);
+      settings_changed();
+    }
+    return;
+  }
+
+  write_eeprom_8(_index + 1, _color.r);
+  write_eeprom_8(_index + 2, _color.g);
+  write_eeprom_8(_index + 3, _color.b);
+  write_eeprom_8(_index, CRGB_UPDATE_DATA);
+}
+#endif
 
-  EEPROM.commit();
+/**
+ * @brief запись контрольной суммы настроек и, при отложенной записи, буфера EEPROM во флеш; вызывается при выходе из режима настроек
+ *
+ */
+void settings_flush()
+{
+#if __USE_EEPROM_WRITE_BEHIND__
+  eeprom_flush();
 #else
-  EEPROM.update(_index + 1, _color.r);
-  EEPROM.update(_index + 2, _color.g);
-  EEPROM.update(_index + 3, _color.b);
-  EEPROM.update(_index, CRGB_UPDATE_DATA);
+  settings_seal();
 #endif
 }
+
+/**
+ * @brief загрузка настроек из EEPROM в кэш и их проверка; вызывается один раз при старте
+ *
+ */
+void settings_load()
+{
+#if defined(ARDUINO_ARCH_STM32)
+  eeprom_buffer_fill();
+#endif
+  clk_settings_loaded = false;
+#if __USE_SETTINGS_LOG__
+  bool from_log = clkSetLog.load();
+  if (!from_log) // журнала еще нет - настройки считываются с фиксированных адресов и переносятся в журнал
+#endif
+  {
+    for (uint8_t i = 0; i < SETTINGS_ITEM_COUNT; i++)
+    {
+      clkSettingItem item;
+      memcpy_P(&item, &settings_items[i], sizeof(clkSettingItem));
+      uint8_t *p = (uint8_t *)&clk_settings + item.offset;
+      if (item.size == 2)
+      {
+        uint16_t x = eeprom_read_16(item.index);
+        memcpy(p, &x, 2);
+      }
+      else
+      {
+        for (uint8_t j = 0; j < item.size; j++)
+        {
+          p[j] = eeprom_read(item.index + j);
+        }
+      }
+    }
+  }
+  clk_settings_loaded = true;
+#if __USE_SETTINGS_LOG__
+  if (!from_log)
+  {
+    clkSetLog.format();
+  }
+  else if (clkSetLog.isComplete())
+  {
+    // все записи журнала прошли проверку CRC, а контрольная сумма в снимке
+    // могла устареть после последующих записей - она пересчитывается
+    clk_settings.schema_crc = settings_checksum();
+  }
 #endif
+
+  settings_check();
+}
@@ -96,11 +96,17 @@ public:
   void setAlarmPoint(uint16_t _time);
 
   /**
-   * @brief проверка текущего состояния будильника
+   * @brief срабатывание включенного будильника; вызывается задачей по
+   *        расписанию в момент, заданный setAlarmPoint()
    *
-   * @param _time текущее время
    */
-  void tick(clkDateTime _time);
+  void trigger();
+
+  /**
+   * @brief обработка текущего состояния будильника (светодиод)
+   *
+   */
+  void tick();
 };
 
 // ---- clkAlarmClass private -------------------
@@ -138,14 +144,7 @@ clkAlarmClass::clkAlarmClass(int8_t _led_pin, uint16_t _eeprom_index)
 
 void clkAlarmClass::init()
 {
-  if (read_eeprom_8(eeprom_index + ALARM_STATE) > 1)
-  {
-    write_eeprom_8(eeprom_index + ALARM_STATE, 0);
-  }
-  if (read_eeprom_16(eeprom_index + ALARM_POINT) > MAX_DATA)
-  {
-    write_eeprom_16(eeprom_index + ALARM_POINT, 360);
-  }
+  // корректность настроек будильника проверяется по схеме настроек при их загрузке (settings_check())
   state = (clkAlarmState)read_eeprom_8(eeprom_index + ALARM_STATE);
 }
 
@@ -165,24 +164,19 @@ uint16_t clkAlarmClass::getAlarmPoint() { return (read_eeprom_16(eeprom_index +
 
 void clkAlarmClass::setAlarmPoint(uint16_t _time) { write_eeprom_16(eeprom_index + ALARM_POINT, _time); }
 
-void clkAlarmClass::tick(clkDateTime _time)
+void clkAlarmClass::trigger()
+{
+  if (state == ALARM_ON)
+  {
+    state = ALARM_YES;
+  }
+}
+
+void clkAlarmClass::tick()
 {
 #if ALARM_LED_PIN >= 0
   setLed();
 #endif
-  switch (state)
-  {
-  case ALARM_ON:
-    uint32_t tm;
-    tm = _time.hour() * 3600ul + _time.minute() * 60ul + _time.second();
-    if (tm == getAlarmPoint() * 60ul)
-    {
-      state = ALARM_YES;
-    }
-    break;
-  default:
-    break;
-  }
 }
 
 // ==== end clkAlarmClass ============================
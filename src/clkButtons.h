@@ -15,6 +15,7 @@
 #include "clkAlarmClass.h"
 #endif
 #include "clkTaskManager.h"
+#include "clkEventBus.h"
 
 // ==== clkButton ====================================
 
@@ -561,7 +562,14 @@ uint8_t clkButtonGroup::getButtonState(clkButtonType _btn)
 {
   if (isValidButton(_btn))
   {
-    return (buttons[(uint8_t)_btn]->getButtonState());
+    uint8_t last = buttons[(uint8_t)_btn]->getLastState();
+    uint8_t result = buttons[(uint8_t)_btn]->getButtonState();
+    // о событиях кнопки сообщается в очередь событий; непрерывное удержание - только один раз
+    if (result >= BTN_UP && !(result == BTN_LONGCLICK && last == BTN_LONGCLICK))
+    {
+      clkEvents.post(CLK_EV_BUTTON, CLK_EV_BUTTON_ARG(_btn, result));
+    }
+    return (result);
   }
 
   return BTN_RELEASED;
@@ -64,7 +64,82 @@ bool clkClockEvent::getState() { return state; }
 
 // ===================================================
 
+/*
+ * подписки на смену секунды, минуты, часа или суток; флаги пересеченных
+ * границ выставляет clkClock при каждом опросе RTC, поэтому подписчик
+ * вызывается ровно один раз на границу и сам время не сравнивает
+ */
+
+#if !defined(ROLLOVER_EVENT_COUNT)
+#define ROLLOVER_EVENT_COUNT 4 // максимальное количество подписок на смену секунды/минуты/часа/суток
+#endif
+
+class clkRolloverEvent
+{
+private:
+  uint8_t mask[ROLLOVER_EVENT_COUNT];
+  clkEventCallback callback[ROLLOVER_EVENT_COUNT];
+
+public:
+  clkRolloverEvent();
+
+  bool add(uint8_t _rollover, clkEventCallback _callback);
+
+  void remove(clkEventCallback _callback);
+
+  void run(uint8_t _rollover);
+};
+
+clkRolloverEvent::clkRolloverEvent()
+{
+  for (uint8_t i = 0; i < ROLLOVER_EVENT_COUNT; i++)
+  {
+    mask[i] = 0;
+    callback[i] = NULL;
+  }
+}
+
+bool clkRolloverEvent::add(uint8_t _rollover, clkEventCallback _callback)
+{
+  for (uint8_t i = 0; i < ROLLOVER_EVENT_COUNT; i++)
+  {
+    if (callback[i] == NULL || callback[i] == _callback)
+    {
+      mask[i] = _rollover;
+      callback[i] = _callback;
+      return (true);
+    }
+  }
+  return (false);
+}
+
+void clkRolloverEvent::remove(clkEventCallback _callback)
+{
+  for (uint8_t i = 0; i < ROLLOVER_EVENT_COUNT; i++)
+  {
+    if (callback[i] == _callback)
+    {
+      mask[i] = 0;
+      callback[i] = NULL;
+    }
+  }
+}
+
+void clkRolloverEvent::run(uint8_t _rollover)
+{
+  for (uint8_t i = 0; i < ROLLOVER_EVENT_COUNT; i++)
+  {
+    if ((mask[i] & _rollover) && callback[i] != NULL)
+    {
+      callback[i]();
+    }
+  }
+}
+
+// ===================================================
+
 clkClockEvent sscClockEvent;
+clkRolloverEvent sscRolloverEvent;
 
 #if defined(USE_ALARM)
 clkClockEvent sscAlarmEvent;
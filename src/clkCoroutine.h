@@ -0,0 +1,153 @@
+/**
+ * @file clkCoroutine.h
+ * @author Vladimir Shatalov (valesh-soft@yandex.ru)
+ *
+ * @brief легковесные сопрограммы (protothreads) для задач диспетчера задач
+ *
+ * @version 1.0
+ * @date 19.10.2026
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#pragma once
+
+// ==== clkCoroutine =================================
+
+/*
+ * сопрограмма - это функция задачи clkTaskManager, которая может прервать
+ * свое выполнение в середине (дождаться паузы, события или условия) и при
+ * следующем срабатывании задачи продолжить с того же места; так многошаговые
+ * операции записываются последовательно, без ручного конечного автомата;
+ *
+ * сопрограмма не имеет своего стека: точка продолжения хранится в структуре
+ * clkCoroutine (номер строки исходника и время начала паузы - 6 байт на AVR),
+ * поэтому:
+ *   - локальные переменные функции между ожиданиями не сохраняются - все,
+ *     что должно пережить ожидание (например, счетчики циклов), хранится в
+ *     структуре состояния, передаваемой задаче как контекст;
+ *   - внутри тела сопрограммы нельзя использовать оператор switch и
+ *     размещать два ожидания в одной строке;
+ *
+ * пример - задача мигает светодиодом три раза, затем ждет нажатия кнопки:
+ *
+ *   struct Blink { clkCoroutine co; uint8_t n; } blink;
+ *
+ *   void blinkTask(void *_ctx)
+ *   {
+ *     Blink *b = static_cast<Blink *>(_ctx);
+ *     CLK_CO_BEGIN(b->co);
+ *     for (b->n = 0; b->n < 3; b->n++)
+ *     {
+ *       digitalWrite(13, HIGH);
+ *       CLK_CO_DELAY(b->co, 200);
+ *       digitalWrite(13, LOW);
+ *       CLK_CO_DELAY(b->co, 200);
+ *     }
+ *     CLK_CO_AWAIT(b->co, digitalRead(4) == LOW);
+ *     CLK_CO_END(b->co);
+ *   }
+ *
+ *   simple_clock.addAdditionalTask(10ul, blinkTask, &blink);
+ *
+ * интервал задачи определяет, как часто проверяются условия ожидания, т.е.
+ * точность пауз
+ */
+
+static const uint16_t CLK_CO_FINISHED = 0xFFFF;
+
+struct clkCoroutine
+{
+  uint16_t line = 0;       // точка продолжения; 0 - начало, CLK_CO_FINISHED - сопрограмма завершена
+  unsigned long wake = 0;  // время начала текущей паузы
+
+  /**
+   * @brief перезапуск сопрограммы с начала
+   *
+   */
+  void reset() { line = 0; }
+
+  /**
+   * @brief завершилась ли сопрограмма
+   *
+   * @return true
+   * @return false
+   */
+  bool isFinished() { return (line == CLK_CO_FINISHED); }
+};
+
+/*
+ * событие для ожидания в сопрограмме; может выставляться в том числе из
+ * обработчика прерывания; ожидание сбрасывает событие
+ */
+struct clkCoEvent
+{
+  volatile bool flag = false;
+
+  void signal() { flag = true; }
+
+  bool take()
+  {
+    // флаг сбрасывается, только если был выставлен, - иначе событие, пришедшее
+    // из прерывания между чтением и сбросом флага, потерялось бы
+    if (flag)
+    {
+      flag = false;
+      return (true);
+    }
+    return (false);
+  }
+};
+
+// переход к метке case внутри CLK_CO_AWAIT - намеренный
+#if defined(__GNUC__) && __GNUC__ >= 7
+#define CLK_CO_FALLTHROUGH __attribute__((fallthrough))
+#else
+#define CLK_CO_FALLTHROUGH
+#endif
+
+// начало тела сопрограммы
+#define CLK_CO_BEGIN(co) \
+  switch ((co).line)     \
+  {                      \
+  case 0:
+
+// отдать управление до следующего срабатывания задачи
+#define CLK_CO_YIELD(co)   \
+  do                       \
+  {                        \
+    (co).line = __LINE__;  \
+    return;                \
+  case __LINE__:;          \
+  } while (0)
+
+// ждать, пока условие не станет истинным
+#define CLK_CO_AWAIT(co, cond) \
+  do                           \
+  {                            \
+    (co).line = __LINE__;      \
+    CLK_CO_FALLTHROUGH;        \
+  case __LINE__:               \
+    if (!(cond))               \
+    {                          \
+      return;                  \
+    }                          \
+  } while (0)
+
+// пауза на заданное число миллисекунд
+#define CLK_CO_DELAY(co, ms)                                            \
+  do                                                                    \
+  {                                                                     \
+    (co).wake = millis();                                               \
+    CLK_CO_AWAIT(co, millis() - (co).wake >= (unsigned long)(ms));      \
+  } while (0)
+
+// ждать события clkCoEvent
+#define CLK_CO_AWAIT_EVENT(co, ev) CLK_CO_AWAIT(co, (ev).take())
+
+// конец тела сопрограммы; после него сопрограмма считается завершенной до вызова reset()
+#define CLK_CO_END(co) \
+  }                    \
+  (co).line = CLK_CO_FINISHED
+
+// ==== end clkCoroutine =============================
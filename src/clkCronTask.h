@@ -0,0 +1,342 @@
+/**
+ * @file clkCronTask.h
+ * @author Vladimir Shatalov (valesh-soft@yandex.ru)
+ *
+ * @brief задачи, привязанные к времени часов (по расписанию)
+ *
+ * @version 1.0
+ * @date 19.10.2026
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#pragma once
+#include "clkTaskManager.h"
+
+// ==== clkCronTask ==================================
+
+/*
+ * в отличие от задач clkTaskManager, которые срабатывают через заданный
+ * интервал millis(), задачи по расписанию срабатывают в заданные моменты
+ * местного времени часов - ровно один раз на каждое совпадение;
+ *
+ * расписание (clkCronSpec) задается временем первого срабатывания в сутках,
+ * периодом повторения в течение суток и маской дней недели:
+ *   clkCronEvery(15)            - каждые 15 минут (в 00, 15, 30 и 45 минут);
+ *   clkCronDaily(7, 30)         - ежедневно в 07:30;
+ *   clkCronDaily(7, 30, CLK_WEEKDAYS) - в 07:30 по рабочим дням;
+ *
+ * для каждой задачи заранее вычисляется время следующего срабатывания, а
+ * для всего списка - ближайшее из них, поэтому, пока оно не наступило,
+ * tick() сводится к одному сравнению;
+ *
+ * если срабатывания были пропущены (например, из-за долгой блокирующей
+ * операции), они выполняются при следующем вызове tick() - столько раз,
+ * сколько было пропущено; если же время ушло вперед больше, чем на
+ * CRON_CATCH_UP_WINDOW секунд (часы были переставлены), пропущенные
+ * срабатывания отбрасываются - кроме перехода на летнее время: время UTC
+ * при этом идет непрерывно, и срабатывания, попавшие в пропущенный час,
+ * выполняются один раз, чтобы не потерять, например, будильник на 02:30;
+ * при переводе часов
+ * назад время следующего срабатывания вычисляется заново - кроме перехода
+ * на зимнее время: время UTC при этом идет дальше, и повторный час не
+ * должен повторять уже выполненные срабатывания, поэтому задачи ждут
+ * прежнего времени следующего срабатывания
+ */
+
+#if !defined(ADDITIONAL_CRON_TASK_COUNT)
+#define ADDITIONAL_CRON_TASK_COUNT 0
+#endif
+
+#if !defined(CRON_CATCH_UP_WINDOW)
+#define CRON_CATCH_UP_WINDOW 300ul // максимальное отставание, при котором пропущенные срабатывания выполняются, секунд
+#endif
+
+static const uint8_t CLK_EVERY_DAY = 0x7F; // маска дней недели: бит 0 - воскресенье, бит 6 - суббота
+static const uint8_t CLK_WEEKDAYS = 0x3E;
+static const uint8_t CLK_WEEKEND = 0x41;
+static const uint32_t CLK_CRON_NEVER = 0xFFFFFFFF;
+
+struct clkCronSpec
+{
+  uint16_t start;  // время первого срабатывания, минут от начала суток
+  uint16_t period; // период повторения в течение суток, минут; 0 - один раз в сутки
+  uint8_t days;    // маска дней недели; 0 - задача не срабатывает никогда
+};
+
+clkCronSpec clkCronEvery(uint16_t _minutes, uint8_t _days = CLK_EVERY_DAY)
+{
+  clkCronSpec result = {0, _minutes, _days};
+  return (result);
+}
+
+clkCronSpec clkCronDaily(uint8_t _hour, uint8_t _minute, uint8_t _days = CLK_EVERY_DAY)
+{
+  clkCronSpec result = {(uint16_t)(_hour * 60 + _minute), 0, _days};
+  return (result);
+}
+
+struct clkCronTask // структура, описывающая задачу по расписанию
+{
+  bool status;              // статус задачи
+  clkCronSpec spec;         // расписание
+  uint32_t next;            // время следующего срабатывания, местное, секунд с 01.01.1970
+  clkTaskCallback callback; // функция, вызываемая при срабатывании
+  void *context;            // данные, передаваемые функции задачи
+};
+
+static constexpr uint8_t CLK_BUILTIN_CRON_TASK_COUNT = 0
+#if defined(USE_ALARM)
+                                                       + 1
+#endif
+#if __USE_AUTO_SHOW_DATA__
+                                                       + 1
+#endif
+    ;
+
+static constexpr uint8_t CLK_CRON_TASK_COUNT = CLK_BUILTIN_CRON_TASK_COUNT + ADDITIONAL_CRON_TASK_COUNT;
+
+template <uint8_t N>
+class clkCronManager
+{
+private:
+  static_assert(N > 0 && N <= 127, "the cron task list size must be in the range 1..127");
+
+  clkCronTask taskList[N];
+  uint8_t count = 0;
+  uint32_t last = 0;                  // время предыдущего вызова tick()
+  uint32_t last_utc = 0;              // время UTC предыдущего вызова tick()
+  uint32_t next_due = CLK_CRON_NEVER; // ближайшее срабатывание среди всех активных задач
+
+  bool isValidHandle(clkHandle _handle);
+
+  uint32_t getNextMatch(const clkCronSpec &_spec, uint32_t _time);
+
+  void updateNextDue();
+
+public:
+  static constexpr uint8_t capacity = N;
+
+#if defined(USE_ALARM)
+  clkHandle alarm_trigger; // срабатывание будильника
+#endif
+#if __USE_AUTO_SHOW_DATA__
+  clkHandle auto_show_trigger; // запуск автовывода даты и/или температуры
+#endif
+
+  clkCronManager() {}
+
+  /**
+   * @brief проверка расписания; вызывается при каждой смене секунды
+   *
+   * @param _time текущее местное время, секунд с 01.01.1970
+   * @param _utc текущее время UTC, секунд с 01.01.1970; без часового пояса совпадает с _time
+   */
+  void tick(uint32_t _time, uint32_t _utc);
+
+  clkHandle addTask(clkCronSpec _spec, clkTaskCallback _callback, void *_context, bool isActive = true);
+
+  clkHandle addTask(clkCronSpec _spec, clkTaskManagerCallback _callback, bool isActive = true);
+
+  void setTaskSpec(clkHandle _handle, clkCronSpec _spec);
+
+  void startTask(clkHandle _handle);
+
+  void stopTask(clkHandle _handle);
+
+  bool getTaskState(clkHandle _handle);
+
+  /**
+   * @brief время следующего срабатывания задачи
+   *
+   * @param _handle идентификатор задачи
+   * @return uint32_t местное время, секунд с 01.01.1970; CLK_CRON_NEVER, если задача не активна
+   */
+  uint32_t getNextTime(clkHandle _handle);
+};
+
+// ---- clkCronManager private ------------------
+
+template <uint8_t N>
+bool clkCronManager<N>::isValidHandle(clkHandle _handle)
+{
+  return (_handle > CLK_INVALID_HANDLE && _handle < count);
+}
+
+template <uint8_t N>
+uint32_t clkCronManager<N>::getNextMatch(const clkCronSpec &_spec, uint32_t _time)
+{
+  uint32_t day = _time / 86400ul;
+  uint32_t sec = _time % 86400ul;
+
+  // ближайшее совпадение ищется не дальше, чем через неделю
+  for (uint8_t i = 0; i < 8; i++, day++)
+  {
+    // 01.01.1970 - четверг
+    if (!(_spec.days & (1 << ((day + 4) % 7))))
+    {
+      continue;
+    }
+
+    uint16_t m = _spec.start;
+    if (i == 0 && m * 60ul <= sec)
+    {
+      // сегодня первое срабатывание уже прошло - ищется следующее после текущей минуты
+      if (_spec.period == 0)
+      {
+        continue;
+      }
+      m += ((sec / 60 - m) / _spec.period + 1) * _spec.period;
+    }
+    if (m < 1440)
+    {
+      return (day * 86400ul + m * 60ul);
+    }
+  }
+
+  return (CLK_CRON_NEVER);
+}
+
+template <uint8_t N>
+void clkCronManager<N>::updateNextDue()
+{
+  next_due = CLK_CRON_NEVER;
+  for (uint8_t i = 0; i < count; i++)
+  {
+    if (taskList[i].status && taskList[i].next < next_due)
+    {
+      next_due = taskList[i].next;
+    }
+  }
+}
+
+// ---- clkCronManager public -------------------
+
+template <uint8_t N>
+void clkCronManager<N>::tick(uint32_t _time, uint32_t _utc)
+{
+  bool back = (_time < last);
+  bool shift = false; // переход на летнее время
+  if (last_utc > 0 && _utc >= last_utc && _utc - last_utc <= CRON_CATCH_UP_WINDOW)
+  {
+    // местное время ушло назад или далеко вперед, а UTC нет - сменилось
+    // смещение часового пояса
+    shift = !back && _time - last > CRON_CATCH_UP_WINDOW;
+    back = false;
+  }
+  last = _time;
+  last_utc = _utc;
+  if (!back && _time < next_due)
+  {
+    return;
+  }
+
+  for (uint8_t i = 0; i < count; i++)
+  {
+    clkCronTask &t = taskList[i];
+    if (!t.status)
+    {
+      continue;
+    }
+
+    if (back || (_time >= t.next && _time - t.next > CRON_CATCH_UP_WINDOW))
+    {
+      bool skipped = shift && t.next <= _time;
+      // часы переставлены - пропущенные срабатывания не выполняются; при
+      // переходе на летнее время срабатывания из пропущенного часа
+      // выполняются один раз
+      t.next = getNextMatch(t.spec, _time - 1);
+      if (skipped)
+      {
+        t.callback(t.context);
+      }
+    }
+
+    // задача может быть остановлена в собственном callback
+    while (t.status && t.next <= _time)
+    {
+      t.next = getNextMatch(t.spec, t.next);
+      t.callback(t.context);
+    }
+  }
+
+  updateNextDue();
+}
+
+template <uint8_t N>
+clkHandle clkCronManager<N>::addTask(clkCronSpec _spec, clkTaskCallback _callback, void *_context, bool isActive)
+{
+  if (count >= N || _callback == nullptr)
+  {
+    return (CLK_INVALID_HANDLE);
+  }
+
+  clkCronTask &t = taskList[count];
+  t.status = isActive;
+  t.spec = _spec;
+  t.next = getNextMatch(_spec, last);
+  t.callback = _callback;
+  t.context = _context;
+  updateNextDue();
+
+  return (count++);
+}
+
+template <uint8_t N>
+clkHandle clkCronManager<N>::addTask(clkCronSpec _spec, clkTaskManagerCallback _callback, bool isActive)
+{
+  if (_callback == nullptr)
+  {
+    return (CLK_INVALID_HANDLE);
+  }
+
+  return (addTask(_spec, clk_plain_task, reinterpret_cast<void *>(_callback), isActive));
+}
+
+template <uint8_t N>
+void clkCronManager<N>::setTaskSpec(clkHandle _handle, clkCronSpec _spec)
+{
+  if (isValidHandle(_handle))
+  {
+    taskList[_handle].spec = _spec;
+    taskList[_handle].next = getNextMatch(_spec, last);
+    updateNextDue();
+  }
+}
+
+template <uint8_t N>
+void clkCronManager<N>::startTask(clkHandle _handle)
+{
+  if (isValidHandle(_handle))
+  {
+    taskList[_handle].status = true;
+    taskList[_handle].next = getNextMatch(taskList[_handle].spec, last);
+    updateNextDue();
+  }
+}
+
+template <uint8_t N>
+void clkCronManager<N>::stopTask(clkHandle _handle)
+{
+  if (isValidHandle(_handle))
+  {
+    taskList[_handle].status = false;
+    updateNextDue();
+  }
+}
+
+template <uint8_t N>
+bool clkCronManager<N>::getTaskState(clkHandle _handle)
+{
+  return (isValidHandle(_handle) && taskList[_handle].status);
+}
+
+template <uint8_t N>
+uint32_t clkCronManager<N>::getNextTime(clkHandle _handle)
+{
+  return ((getTaskState(_handle)) ? taskList[_handle].next : CLK_CRON_NEVER);
+}
+
+// ==== end clkCronTask ==============================
+
+clkCronManager<(CLK_CRON_TASK_COUNT > 0) ? CLK_CRON_TASK_COUNT : 1> clkCron;
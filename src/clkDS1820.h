@@ -20,11 +20,16 @@
  *           data_pin - пин, к которому подключен датчик (наличие резистора 
  *                      4.7кОм между пином данных и VCC обязательно)
  *
- *        void readData() - опрос датчика; следует вызывать не чаще одного раза
- *                          в секунду, а лучше реже, т.к. при слишком частом 
- *                          опросе микросхема датчика начинает вносить искажения
- *                          в температуру за счет собственного разогрева; 
- *                          считанные данные помещаются в поле temp;
+ *        void startConversion() - команда датчику на измерение температуры;
+ *                          результат готов через DS18B20_CONVERSION_TIME мс;
+ *
+ *        void readData() - считывание результата измерения, запущенного
+ *                          startConversion(); опрашивать датчик следует не
+ *                          чаще одного раза в секунду, а лучше реже, т.к. при
+ *                          слишком частом опросе микросхема датчика начинает
+ *                          вносить искажения в температуру за счет
+ *                          собственного разогрева; считанные данные
+ *                          помещаются в поле temp;
  *
  *        int16_t getTemp() - получение ранее считанной из дачика температуры;
  * 
@@ -39,6 +44,7 @@
 #include <OneWire.h> // https://github.com/PaulStoffregen/OneWire
 
 #define ERROR_TEMP -127
+#define DS18B20_CONVERSION_TIME 750ul // время измерения при разрешении 12 бит, мс
 
 OneWire sscDS18b20;
 
@@ -57,7 +63,14 @@ public:
   void init(uint8_t data_pin);
 
   /**
-   * @brief считывание показаний датчика; вызывать не чаще одного раза в секунду
+   * @brief запуск измерения температуры
+   *
+   */
+  void startConversion();
+
+  /**
+   * @brief считывание результата измерения; вызывать не раньше, чем через
+   *        DS18B20_CONVERSION_TIME мс после startConversion()
    *
    */
   void readData();
@@ -115,12 +128,16 @@ void clkDS1820::init(uint8_t data_pin)
         break;
       }
     }
-    if (type_c < 2)
-    {
-      sscDS18b20.reset();
-      sscDS18b20.select(addr);
-      sscDS18b20.write(0x44, 1);
-    }
+  }
+}
+
+void clkDS1820::startConversion()
+{
+  if (type_c < 2)
+  {
+    sscDS18b20.reset();
+    sscDS18b20.select(addr);
+    sscDS18b20.write(0x44, 1);
   }
 }
 
@@ -175,11 +192,6 @@ void clkDS1820::readData()
         temp++;
       }
     }
-
-    // даем команду на конвертацию для следующего запроса
-    sscDS18b20.reset();
-    sscDS18b20.select(addr);
-    sscDS18b20.write(0x44, 1);
   }
 }
 
@@ -20,11 +20,16 @@
  *           data_pin - пин, к которому подключен датчик (наличие резистора 
  *                      4.7кОм между пином данных и VCC обязательно)
  *
- *        void readData() - опрос датчика; следует вызывать не чаще одного раза
- *                          в секунду, а лучше реже, т.к. при слишком частом 
- *                          опросе микросхема датчика начинает вносить искажения
- *                          в температуру за счет собственного разогрева; 
- *                          считанные данные помещаются в поле temp;
+ *        void startConversion() - команда датчику на измерение температуры;
+ *                          результат готов через DS18B20_CONVERSION_TIME мс;
+ *
+ *        void readData() - считывание результата измерения, запущенного
+ *                          startConversion(); опрашивать датчик следует не
+ *                          чаще одного раза в секунду, а лучше реже, т.к. при
+ *                          слишком частом опросе микросхема датчика начинает
+ *                          вносить искажения в температуру за счет
+ *                          собственного разогрева; считанные данные
+ *                          помещаются в поле temp;
  *
  *        int16_t getTemp() - получение ранее считанной из дачика температуры;
  * 
@@ -43,6 +48,7 @@
 #include <utils/Placeholder.h>
 
 #define ERROR_TEMP -127
+#define DS18B20_CONVERSION_TIME 750ul // время измерения при разрешении 12 бит, мс
 
 static Placeholder<OneWireNg_CurrentPlatform> ow;
 
@@ -65,7 +71,14 @@ public:
   void init(int8_t data_pin);
 
   /**
-   * @brief считывание показаний датчика; вызывать не чаще одного раза в секунду
+   * @brief запуск измерения температуры
+   *
+   */
+  void startConversion();
+
+  /**
+   * @brief считывание результата измерения; вызывать не раньше, чем через
+   *        DS18B20_CONVERSION_TIME мс после startConversion()
    *
    */
   void readData();
@@ -124,10 +137,17 @@ void clkDS1820_ng::init(int8_t data_pin)
     // полученной температуры
     drv.writeScratchpad(scrpd->getId(), -10, 60, DSTherm::RES_9_BIT);
     drv.copyScratchpad(scrpd->getId(), false);
-    drv.convertTemp(scrpd->getId());
   }
 }
 
+void clkDS1820_ng::startConversion()
+{
+  // датчик на линии один, поэтому команда отправляется без адреса; без
+  // ожидания результата (maxConvTime = 0), его дожидается вызывающий
+  DSTherm drv(ow);
+  drv.convertTempAll(0);
+}
+
 void clkDS1820_ng::readData()
 {
   DSTherm drv(ow);
@@ -135,11 +155,7 @@ void clkDS1820_ng::readData()
   OneWireNg::ErrorCode ec = drv.readScratchpadSingle(scrpd);
   if (ec == OneWireNg::EC_SUCCESS)
   {
-    if (checkData(scrpd))
-    {
-      // если пришли корректные данные, послать команду для следующей итерации
-      drv.convertTemp(scrpd->getId(), 0);
-    }
+    checkData(scrpd);
   }
   else
   {
@@ -169,10 +169,17 @@ uint8_t clkDisplayMAX72xx7segment<cs_pin>::getBrightness()
   return _brightness;
 }
 
-// ==== класс для матрицы 8х8х4 MAX72xx ==============
+// ==== класс для матрицы MAX72xx ===================
 
-template <uint8_t cs_pin>
-class clkDisplayMAX72xxMatrix : public shMAX72xxMini<cs_pin, 4>
+/**
+ * @brief класс матрицы, собранной из модулей 8х8 MAX72xx
+ *
+ * @tparam cs_pin пин CS
+ * @tparam col_count количество столбцов матрицы (ширина), кратно 8
+ * @tparam row_count количество строк матрицы (высота), кратно 8; модули соединяются построчно, слева направо
+ */
+template <uint8_t cs_pin, uint16_t col_count = 32, uint8_t row_count = 8>
+class clkDisplayMAX72xxMatrix : public shMAX72xxMini<cs_pin, col_count / 8 * (row_count / 8)>
 {
 private:
   uint8_t _brightness = 0;
@@ -181,27 +188,41 @@ private:
   //                   uint8_t width = 6, uint8_t space = 1,
   //                   uint8_t *_data = NULL, uint8_t _data_count = 0);
 
-  void setChar(uint8_t offset, uint8_t chr,
-               uint8_t width = 6, uint8_t *_arr = NULL, uint8_t _arr_length = 0);
+  void setChar(uint16_t offset, uint8_t chr,
+               uint8_t width = 6, uint8_t *_arr = NULL, uint16_t _arr_length = 0);
 
 public:
-  clkDisplayMAX72xxMatrix() : shMAX72xxMini<cs_pin, 4>() { clear(); }
+  clkDisplayMAX72xxMatrix() : shMAX72xxMini<cs_pin, col_count / 8 * (row_count / 8)>() { clear(); }
 
   /**
    * @brief запись столбца в буфер экрана
    *
    * @param col столбец
    * @param _data байт для записи
+   * @param line строка модулей, в которую выполняется запись (0 - верхняя)
    */
-  void setColumn(uint8_t col, uint8_t _data);
+  void setColumn(uint16_t col, uint8_t _data, uint8_t line = 0);
 
   /**
    * @brief получение битовой маски столбца из буфера устройства
    *
    * @param column столбец (координата X)
+   * @param line строка модулей (0 - верхняя)
    * @return результат
    */
-  uint8_t getColumn(uint8_t col);
+  uint8_t getColumn(uint16_t col, uint8_t line = 0);
+
+#if defined(USE_DIGIT_ANIMATION)
+  /**
+   * @brief запись в буфер экрана промежуточного кадра смены столбца; новые данные прокручиваются сверху вниз, вытесняя старые
+   *
+   * @param col столбец
+   * @param _old прежняя битовая маска столбца
+   * @param _new новая битовая маска столбца
+   * @param step номер кадра (0..DIGIT_ANIMATION_STEPS)
+   */
+  void setColumnTransition(uint16_t col, uint8_t _old, uint8_t _new, uint8_t step);
+#endif
 
   /**
    * @brief очистка экрана
@@ -213,11 +234,11 @@ public:
   /**
    * @brief запись символа в буфера экрана
    *
-   * @param offset индекс столбца, с которого начинается отрисовка символа (0..31)
+   * @param offset индекс столбца, с которого начинается отрисовка символа (0..col_count - 1)
    * @param chr символ для записи
    * @param width ширина символа, может иметь значение 5 или 6, определяет, какой набор символов будет использован: 5х7 (для текста) или 6х8 (для вывода цифр)
    */
-  void setDispData(uint8_t offset, uint8_t chr, uint8_t width = 6);
+  void setDispData(uint16_t offset, uint8_t chr, uint8_t width = 6);
 
   /**
    * @brief вывести двоеточие в середине экрана
@@ -249,8 +270,8 @@ public:
 
 // ---- clkDisplayMAX72xxMatrix private ------------
 
-// template <uint8_t cs_pin>
-// void clkDisplayMAX72xxMatrix<cs_pin>::setNumString(uint8_t offset, uint8_t num,
+// template <uint8_t cs_pin, uint16_t col_count, uint8_t row_count>
+// void clkDisplayMAX72xxMatrix<cs_pin, col_count, row_count>::setNumString(uint8_t offset, uint8_t num,
 //                                         uint8_t width, uint8_t space,
 //                                         uint8_t *_data, uint8_t _data_count)
 // {
@@ -260,11 +281,11 @@ public:
 //   setChar(offset + width + space, x, width, _data, _data_count);
 // }
 
-template <uint8_t cs_pin>
-void clkDisplayMAX72xxMatrix<cs_pin>::setChar(uint8_t offset, uint8_t chr,
-                                           uint8_t width, uint8_t *_arr, uint8_t _arr_length)
+template <uint8_t cs_pin, uint16_t col_count, uint8_t row_count>
+void clkDisplayMAX72xxMatrix<cs_pin, col_count, row_count>::setChar(uint16_t offset, uint8_t chr,
+                                                                       uint8_t width, uint8_t *_arr, uint16_t _arr_length)
 {
-  for (uint8_t j = offset, i = 0; i < width; j++, i++)
+  for (uint16_t j = offset, i = 0; i < width; j++, i++)
   {
     uint8_t chr_data = 0;
     switch (width)
@@ -288,9 +309,9 @@ void clkDisplayMAX72xxMatrix<cs_pin>::setChar(uint8_t offset, uint8_t chr,
     }
     else
     {
-      if (j < 32)
+      if (j < col_count)
       {
-        shMAX72xxMini<cs_pin, 4>::setColumn(j / 8, j % 8, chr_data);
+        setColumn(j, chr_data);
       }
     }
   }
@@ -298,63 +319,81 @@ void clkDisplayMAX72xxMatrix<cs_pin>::setChar(uint8_t offset, uint8_t chr,
 
 // ---- clkDisplayMAX72xxMatrix public -------------
 
-template <uint8_t cs_pin>
-void clkDisplayMAX72xxMatrix<cs_pin>::setColumn(uint8_t col, uint8_t _data)
+template <uint8_t cs_pin, uint16_t col_count, uint8_t row_count>
+void clkDisplayMAX72xxMatrix<cs_pin, col_count, row_count>::setColumn(uint16_t col, uint8_t _data, uint8_t line)
 {
-  if (col < 32)
+  if (col < col_count && line < row_count / 8)
   {
-    shMAX72xxMini<cs_pin, 4>::setColumn(col / 8, col % 8, _data);
+    shMAX72xxMini<cs_pin, col_count / 8 * (row_count / 8)>::setColumn(line * (col_count / 8) + col / 8, col % 8, _data);
   }
 }
 
-template <uint8_t cs_pin>
-uint8_t clkDisplayMAX72xxMatrix<cs_pin>::getColumn(uint8_t col)
+template <uint8_t cs_pin, uint16_t col_count, uint8_t row_count>
+uint8_t clkDisplayMAX72xxMatrix<cs_pin, col_count, row_count>::getColumn(uint16_t col, uint8_t line)
 {
   uint8_t result = 0x00;
-  if (col < 32)
+  if (col < col_count && line < row_count / 8)
   {
-    result = shMAX72xxMini<cs_pin, 4>::getColumn(col / 8, col % 8);
+    result = shMAX72xxMini<cs_pin, col_count / 8 * (row_count / 8)>::getColumn(line * (col_count / 8) + col / 8, col % 8);
   }
   return (result);
 }
 
-template <uint8_t cs_pin>
-void clkDisplayMAX72xxMatrix<cs_pin>::clear(bool upd)
+#if defined(USE_DIGIT_ANIMATION)
+template <uint8_t cs_pin, uint16_t col_count, uint8_t row_count>
+void clkDisplayMAX72xxMatrix<cs_pin, col_count, row_count>::setColumnTransition(uint16_t col, uint8_t _old,
+                                                                                  uint8_t _new, uint8_t step)
 {
-  shMAX72xxMini<cs_pin, 4>::clearAllDevices(upd);
+  if (step >= DIGIT_ANIMATION_STEPS)
+  {
+    setColumn(col, _new);
+  }
+  else
+  {
+    // старая цифра уходит вниз, новая появляется сверху
+    uint8_t x = step * 8 / DIGIT_ANIMATION_STEPS;
+    setColumn(col, (x == 0) ? _old : ((_old >> x) | (_new << (8 - x))));
+  }
 }
+#endif
 
-template <uint8_t cs_pin>
-void clkDisplayMAX72xxMatrix<cs_pin>::setDispData(uint8_t offset, uint8_t chr, uint8_t width)
+template <uint8_t cs_pin, uint16_t col_count, uint8_t row_count>
+void clkDisplayMAX72xxMatrix<cs_pin, col_count, row_count>::clear(bool upd)
+{
+  shMAX72xxMini<cs_pin, col_count / 8 * (row_count / 8)>::clearAllDevices(upd);
+}
+
+template <uint8_t cs_pin, uint16_t col_count, uint8_t row_count>
+void clkDisplayMAX72xxMatrix<cs_pin, col_count, row_count>::setDispData(uint16_t offset, uint8_t chr, uint8_t width)
 {
   setChar(offset, chr, width);
 }
 
-template <uint8_t cs_pin>
-void clkDisplayMAX72xxMatrix<cs_pin>::setColon(bool toDot)
+template <uint8_t cs_pin, uint16_t col_count, uint8_t row_count>
+void clkDisplayMAX72xxMatrix<cs_pin, col_count, row_count>::setColon(bool toDot)
 {
-  (toDot) ? shMAX72xxMini<cs_pin, 4>::setColumn(1, 7, 0b00000001)
-          : shMAX72xxMini<cs_pin, 4>::setColumn(1, 7, 0b00100100);
+  uint16_t const col = col_count / 2 - 1;
+  (toDot) ? setColumn(col, 0b00000001) : setColumn(col, 0b00100100);
 }
 
-template <uint8_t cs_pin>
-void clkDisplayMAX72xxMatrix<cs_pin>::show()
+template <uint8_t cs_pin, uint16_t col_count, uint8_t row_count>
+void clkDisplayMAX72xxMatrix<cs_pin, col_count, row_count>::show()
 {
-  shMAX72xxMini<cs_pin, 4>::update();
+  shMAX72xxMini<cs_pin, col_count / 8 * (row_count / 8)>::update();
 }
 
-template <uint8_t cs_pin>
-void clkDisplayMAX72xxMatrix<cs_pin>::setBrightness(uint8_t brightness)
+template <uint8_t cs_pin, uint16_t col_count, uint8_t row_count>
+void clkDisplayMAX72xxMatrix<cs_pin, col_count, row_count>::setBrightness(uint8_t brightness)
 {
   _brightness = (brightness <= 15) ? brightness : 15;
-  for (uint8_t i = 0; i < 4; i++)
+  for (uint8_t i = 0; i < col_count / 8 * (row_count / 8); i++)
   {
-    shMAX72xxMini<cs_pin, 4>::setBrightness(i, brightness);
+    shMAX72xxMini<cs_pin, col_count / 8 * (row_count / 8)>::setBrightness(i, brightness);
   }
 }
 
-template <uint8_t cs_pin>
-uint8_t clkDisplayMAX72xxMatrix<cs_pin>::getBrightness()
+template <uint8_t cs_pin, uint16_t col_count, uint8_t row_count>
+uint8_t clkDisplayMAX72xxMatrix<cs_pin, col_count, row_count>::getBrightness()
 {
   return _brightness;
 }
@@ -364,5 +403,5 @@ uint8_t clkDisplayMAX72xxMatrix<cs_pin>::getBrightness()
 #if defined(MAX72XX_7SEGMENT_DISPLAY)
 clkDisplayMAX72xx7segment<DISPLAY_CS_PIN> clkDisplay;
 #else
-clkDisplayMAX72xxMatrix<DISPLAY_CS_PIN> clkDisplay;
-#endif
\ No newline at end of file
+clkDisplayMAX72xxMatrix<DISPLAY_CS_PIN, MATRIX_WIDTH, MATRIX_HEIGHT> clkDisplay;
+#endif
\ No newline at end of file
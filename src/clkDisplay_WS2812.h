@@ -18,6 +18,9 @@
 #endif
 #include <FastLED.h> // https://github.com/FastLED/FastLED
 #include "clkSimpleRTC.h"
+#if __USE_DUAL_CORE__
+#include "clkFrameQueue.h"
+#endif
 
 // ===================================================
 
@@ -44,7 +47,15 @@ static const uint32_t PROGMEM color_of_number[] = {
     0x9600D7  // фиолетовый (Violet)
 };
 
-// ==== класс для матрицы 8х32 адресных светодиодов ==
+// кривая яркости с гамма-коррекцией 2.2 для уровней 0..25; значения в формате 8.8 -
+// старший байт - яркость FastLED, младший - дробная часть, которая отрабатывается
+// временным сглаживанием (dithering); минимальный уровень соответствует яркости чуть выше единицы
+static const uint16_t PROGMEM brightness_curve[] = {
+    0, 311, 507, 869, 1410, 2141, 3071, 4208, 5558, 7126, 8918, 10938, 13192,
+    15683, 18415, 21391, 24616, 28091, 31821, 35808, 40055, 44565, 49340, 54382,
+    59695, 65280};
+
+// ==== класс для матрицы адресных светодиодов =======
 
 /**
  * @brief тип матрицы по расположению светодиодов
@@ -68,27 +79,45 @@ enum clkMatrixType : uint8_t
   BY_LINE
 };
 
-uint16_t const LEDS_COUNT = 256;
-
+/**
+ * @brief класс матрицы адресных светодиодов
+ *
+ * @tparam col_count количество столбцов матрицы (ширина)
+ * @tparam row_count количество строк матрицы (высота), кратно 8
+ */
+template <uint16_t col_count, uint8_t row_count>
 class clkDisplayWS2812Matrix
 {
 private:
-  CRGB leds[LEDS_COUNT];
+  CRGB leds[col_count * row_count];
   clkMatrixType matrix_type = BY_COLUMNS;
-  uint8_t row_count = 8;
-  uint8_t col_count = 32;
   uint8_t _brightness = 0;
+  uint16_t br_value = 0; // яркость по кривой brightness_curve, формат 8.8
+  uint8_t br_error = 0;  // накопленная дробная часть яркости для временного сглаживания
   CRGB color = CRGB::Red;
   CRGB bg_color = CRGB::Black;
 
-  uint8_t getLedIndexOfStrip(uint8_t row, uint8_t col);
+#if __USE_DUAL_CORE__
+  // при выводе на отдельном ядре кадр формируется в leds, а FastLED выводит
+  // копию из out, которую заполняет ядро вывода
+  struct clkFrame
+  {
+    uint8_t brightness;
+    CRGB leds[col_count * row_count];
+  };
+
+  CRGB out[col_count * row_count];
+  clkFrameQueue<clkFrame, 3> frames;
+#endif
+
+  uint16_t getLedIndexOfStrip(uint8_t row, uint16_t col);
 
   // void setNumString(uint8_t offset, uint8_t num,
   //                   uint8_t width = 6, uint8_t space = 1,
   //                   uint8_t *_data = NULL, uint8_t _data_count = 0);
 
-  void setChar(uint8_t offset, uint8_t chr,
-               uint8_t width = 6, uint8_t *_arr = NULL, uint8_t _arr_length = 0);
+  void setChar(uint16_t offset, uint8_t chr,
+               uint8_t width = 6, uint8_t *_arr = NULL, uint16_t _arr_length = 0);
 
 #if __ESPI_CHIPSET__
   void setESpiLedsData(CRGB *data, uint16_t leds_count);
@@ -111,16 +140,30 @@ public:
    *
    * @param col столбец
    * @param _data байт для записи
+   * @param line строка из восьми светодиодов, в которую выполняется запись (0 - верхняя)
    */
-  void setColumn(uint8_t col, uint8_t _data);
+  void setColumn(uint16_t col, uint8_t _data, uint8_t line = 0);
 
   /**
    * @brief получение битовой маски столбца из буфера устройства
    *
    * @param column столбец (координата X)
+   * @param line строка из восьми светодиодов (0 - верхняя)
    * @return результат
    */
-  uint8_t getColumn(uint8_t col);
+  uint8_t getColumn(uint16_t col, uint8_t line = 0);
+
+#if defined(USE_DIGIT_ANIMATION)
+  /**
+   * @brief запись в буфер экрана промежуточного кадра смены столбца; цвет каждого изменившегося светодиода плавно переходит от старого значения к новому
+   *
+   * @param col столбец
+   * @param _old прежняя битовая маска столбца
+   * @param _new новая битовая маска столбца
+   * @param step номер кадра (0..DIGIT_ANIMATION_STEPS)
+   */
+  void setColumnTransition(uint16_t col, uint8_t _old, uint8_t _new, uint8_t step);
+#endif
 
   /**
    * @brief очистка буфера экрана
@@ -132,11 +175,11 @@ public:
   /**
    * @brief запись символа в буфера экрана
    *
-   * @param offset индекс столбца, с которого начинается отрисовка символа (0..31)
+   * @param offset индекс столбца, с которого начинается отрисовка символа (0..col_count - 1)
    * @param chr символ для записи
    * @param width ширина символа, может иметь значение 5 или 6, определяет, какой набор символов будет использован: 5х7 (для текста) или 6х8 (для вывода цифр)
    */
-  void setDispData(uint8_t offset, uint8_t chr, uint8_t width = 6);
+  void setDispData(uint16_t offset, uint8_t chr, uint8_t width = 6);
 
   /**
    * @brief вывести двоеточие в середине экрана
@@ -151,10 +194,19 @@ public:
    */
   void show();
 
+#if __USE_DUAL_CORE__
+  /**
+   * @brief вывод на матрицу последнего сформированного кадра; вызывается на ядре вывода
+   *
+   * @return false, если новых кадров нет
+   */
+  bool render();
+#endif
+
   /**
    * @brief установка яркости экрана
    *
-   * @param brightness значение яркости (0..25)
+   * @param brightness значение яркости (0..25); уровни пересчитываются в яркость светодиодов с гамма-коррекцией, новое значение применяется при следующей отрисовке экрана
    */
   void setBrightness(uint8_t brightness);
 
@@ -212,9 +264,10 @@ public:
 
 // ---- clkDisplayWS2812Matrix private -------------
 
-uint8_t clkDisplayWS2812Matrix::getLedIndexOfStrip(uint8_t row, uint8_t col)
+template <uint16_t col_count, uint8_t row_count>
+uint16_t clkDisplayWS2812Matrix<col_count, row_count>::getLedIndexOfStrip(uint8_t row, uint16_t col)
 {
-  uint8_t result = 0;
+  uint16_t result = 0;
   switch (matrix_type)
   {
   case BY_COLUMNS:
@@ -237,10 +290,11 @@ uint8_t clkDisplayWS2812Matrix::getLedIndexOfStrip(uint8_t row, uint8_t col)
 //   setChar(offset + width + space, x, width);
 // }
 
-void clkDisplayWS2812Matrix::setChar(uint8_t offset, uint8_t chr,
-                                  uint8_t width, uint8_t *_arr, uint8_t _arr_length)
+template <uint16_t col_count, uint8_t row_count>
+void clkDisplayWS2812Matrix<col_count, row_count>::setChar(uint16_t offset, uint8_t chr,
+                                                          uint8_t width, uint8_t *_arr, uint16_t _arr_length)
 {
-  for (uint8_t j = offset, i = 0; i < width; j++, i++)
+  for (uint16_t j = offset, i = 0; i < width; j++, i++)
   {
     uint8_t chr_data = 0;
     switch (width)
@@ -264,7 +318,7 @@ void clkDisplayWS2812Matrix::setChar(uint8_t offset, uint8_t chr,
     }
     else
     {
-      if (j < 32)
+      if (j < col_count)
       {
         setColumn(j, chr_data);
       }
@@ -273,7 +327,8 @@ void clkDisplayWS2812Matrix::setChar(uint8_t offset, uint8_t chr,
 }
 
 #if __ESPI_CHIPSET__
-void clkDisplayWS2812Matrix::setESpiLedsData(CRGB *data, uint16_t leds_count)
+template <uint16_t col_count, uint8_t row_count>
+void clkDisplayWS2812Matrix<col_count, row_count>::setESpiLedsData(CRGB *data, uint16_t leds_count)
 {
 #if defined CHIPSET_LPD6803
   ESPIChipsets const chip = LPD6803;
@@ -302,7 +357,8 @@ void clkDisplayWS2812Matrix::setESpiLedsData(CRGB *data, uint16_t leds_count)
 #endif
 }
 #else
-void clkDisplayWS2812Matrix::setLedsData(CRGB *data, uint16_t leds_count)
+template <uint16_t col_count, uint8_t row_count>
+void clkDisplayWS2812Matrix<col_count, row_count>::setLedsData(CRGB *data, uint16_t leds_count)
 {
 #if defined CHIPSET_NEOPIXEL
   FastLED.addLeds<NEOPIXEL, DISPLAY_DIN_PIN, EORDER>(data, leds_count);
@@ -366,7 +422,8 @@ void clkDisplayWS2812Matrix::setLedsData(CRGB *data, uint16_t leds_count)
 
 // ---- clkDisplayWS2812Matrix public --------------
 
-clkDisplayWS2812Matrix::clkDisplayWS2812Matrix(CRGB _color, clkMatrixType _type)
+template <uint16_t col_count, uint8_t row_count>
+clkDisplayWS2812Matrix<col_count, row_count>::clkDisplayWS2812Matrix(CRGB _color, clkMatrixType _type)
 {
   color = _color;
   bg_color = COLOR_OF_BACKGROUND;
@@ -375,9 +432,10 @@ clkDisplayWS2812Matrix::clkDisplayWS2812Matrix(CRGB _color, clkMatrixType _type)
   setMaxPSP(POWER_SUPPLY_VOLTAGE, POWER_SUPPLY_CURRENT);
 }
 
-void clkDisplayWS2812Matrix::setColumn(uint8_t col, uint8_t _data)
+template <uint16_t col_count, uint8_t row_count>
+void clkDisplayWS2812Matrix<col_count, row_count>::setColumn(uint16_t col, uint8_t _data, uint8_t line)
 {
-  if (col < 32)
+  if (col < col_count && line < row_count / 8)
   {
     for (uint8_t i = 0; i < 8; i++)
     {
@@ -408,27 +466,28 @@ void clkDisplayWS2812Matrix::setColumn(uint8_t col, uint8_t _data)
           break;
         }
 
-        leds[getLedIndexOfStrip(i, col)] =
+        leds[getLedIndexOfStrip(line * 8 + i, col)] =
             (((_data) >> (7 - i)) & 0x01) ? pgm_read_dword(&color_of_number[j])
                                           : bg_color;
       }
       else
       {
-        leds[getLedIndexOfStrip(i, col)] =
+        leds[getLedIndexOfStrip(line * 8 + i, col)] =
             (((_data) >> (7 - i)) & 0x01) ? color : bg_color;
       }
     }
   }
 }
 
-uint8_t clkDisplayWS2812Matrix::getColumn(uint8_t col)
+template <uint16_t col_count, uint8_t row_count>
+uint8_t clkDisplayWS2812Matrix<col_count, row_count>::getColumn(uint16_t col, uint8_t line)
 {
   uint8_t result = 0x00;
-  if (col < 32)
+  if (col < col_count && line < row_count / 8)
   {
     for (uint8_t i = 0; i < 8; i++)
     {
-      CRGB x = leds[getLedIndexOfStrip(i, col)];
+      CRGB x = leds[getLedIndexOfStrip(line * 8 + i, col)];
       (x.r != bg_color.r ||
        x.g != bg_color.g ||
        x.b != bg_color.b)
@@ -439,81 +498,182 @@ uint8_t clkDisplayWS2812Matrix::getColumn(uint8_t col)
   return (result);
 }
 
-void clkDisplayWS2812Matrix::clear(bool upd)
+#if defined(USE_DIGIT_ANIMATION)
+template <uint16_t col_count, uint8_t row_count>
+void clkDisplayWS2812Matrix<col_count, row_count>::setColumnTransition(uint16_t col, uint8_t _old,
+                                                                      uint8_t _new, uint8_t step)
 {
-  for (uint8_t i = 0; i < 32; i++)
+  if (step >= DIGIT_ANIMATION_STEPS)
   {
-    setColumn(i, 0x00);
+    setColumn(col, _new);
+  }
+  else if (col < col_count)
+  {
+    uint8_t amount = step * 255 / DIGIT_ANIMATION_STEPS;
+    for (uint8_t i = 0; i < 8; i++)
+    {
+      bool o = (_old >> (7 - i)) & 0x01;
+      bool n = (_new >> (7 - i)) & 0x01;
+      // смешивать цвета только у тех светодиодов, состояние которых меняется
+      leds[getLedIndexOfStrip(i, col)] = (o == n) ? ((n) ? color : bg_color)
+                                                  : blend((o) ? color : bg_color,
+                                                          (n) ? color : bg_color,
+                                                          amount);
+    }
+  }
+}
+#endif
+
+template <uint16_t col_count, uint8_t row_count>
+void clkDisplayWS2812Matrix<col_count, row_count>::clear(bool upd)
+{
+  for (uint8_t line = 0; line < row_count / 8; line++)
+  {
+    for (uint16_t i = 0; i < col_count; i++)
+    {
+      setColumn(i, 0x00, line);
+    }
   }
   if (upd)
   {
+#if __USE_DUAL_CORE__
+    show();
+#else
     FastLED.show();
+#endif
   }
 }
 
-void clkDisplayWS2812Matrix::setDispData(uint8_t offset, uint8_t chr, uint8_t width)
+template <uint16_t col_count, uint8_t row_count>
+void clkDisplayWS2812Matrix<col_count, row_count>::setDispData(uint16_t offset, uint8_t chr, uint8_t width)
 {
-  if (offset < 32)
+  if (offset < col_count)
   {
     setChar(offset, chr, width);
   }
 }
 
-void clkDisplayWS2812Matrix::setColon(bool toDot)
+template <uint16_t col_count, uint8_t row_count>
+void clkDisplayWS2812Matrix<col_count, row_count>::setColon(bool toDot)
 {
-  (toDot) ? setColumn(15, 0b00000001) : setColumn(15, 0b00100100);
+  uint16_t const col = col_count / 2 - 1;
+  (toDot) ? setColumn(col, 0b00000001) : setColumn(col, 0b00100100);
 }
 
-void clkDisplayWS2812Matrix::show()
+template <uint16_t col_count, uint8_t row_count>
+void clkDisplayWS2812Matrix<col_count, row_count>::show()
 {
+  // яркость выставляется один раз на кадр; дробная часть накапливается от кадра
+  // к кадру, и при переполнении кадр выводится на единицу ярче
+  uint8_t x = highByte(br_value);
+#if defined(USE_BRIGHTNESS_DITHERING)
+  uint16_t e = br_error + lowByte(br_value);
+  br_error = lowByte(e);
+  x += highByte(e);
+#else
+  x += (lowByte(br_value) >= 0x80);
+#endif
+#if __USE_DUAL_CORE__
+  // кадр только ставится в очередь, вывод выполняет другое ядро
+  clkFrame *f = frames.beginWrite();
+  if (f != nullptr)
+  {
+    f->brightness = x;
+    memcpy(f->leds, leds, sizeof(leds));
+    frames.commitWrite();
+  }
+#else
+  FastLED.setBrightness(x);
   FastLED.show();
+#endif
 }
 
-void clkDisplayWS2812Matrix::setBrightness(uint8_t brightness)
+#if __USE_DUAL_CORE__
+template <uint16_t col_count, uint8_t row_count>
+bool clkDisplayWS2812Matrix<col_count, row_count>::render()
+{
+  clkFrame *f = frames.beginRead();
+  if (f == nullptr)
+  {
+    return (false);
+  }
+
+  // если вывод не успевает за логикой, промежуточные кадры пропускаются
+  while (frames.hasNewer())
+  {
+    frames.commitRead();
+    f = frames.beginRead();
+  }
+  uint8_t x = f->brightness;
+  memcpy(out, f->leds, sizeof(out));
+  frames.commitRead();
+
+  FastLED.setBrightness(x);
+  FastLED.show();
+  return (true);
+}
+#endif
+
+template <uint16_t col_count, uint8_t row_count>
+void clkDisplayWS2812Matrix<col_count, row_count>::setBrightness(uint8_t brightness)
 {
   _brightness = (brightness <= 25) ? brightness : 25;
-  FastLED.setBrightness(brightness * 10);
+  br_value = pgm_read_word(&brightness_curve[_brightness]);
 }
 
-uint8_t clkDisplayWS2812Matrix::getBrightness()
+template <uint16_t col_count, uint8_t row_count>
+uint8_t clkDisplayWS2812Matrix<col_count, row_count>::getBrightness()
 {
   return (_brightness);
 }
 
-void clkDisplayWS2812Matrix::setColorOfNumber(CRGB _color)
+template <uint16_t col_count, uint8_t row_count>
+void clkDisplayWS2812Matrix<col_count, row_count>::setColorOfNumber(CRGB _color)
 {
   color = _color;
 }
 
-CRGB clkDisplayWS2812Matrix::getColorOfNumber()
+template <uint16_t col_count, uint8_t row_count>
+CRGB clkDisplayWS2812Matrix<col_count, row_count>::getColorOfNumber()
 {
   return (color);
 }
 
-void clkDisplayWS2812Matrix::setColorOfBackground(CRGB _color)
+template <uint16_t col_count, uint8_t row_count>
+void clkDisplayWS2812Matrix<col_count, row_count>::setColorOfBackground(CRGB _color)
 {
   bg_color = _color;
 }
 
-CRGB clkDisplayWS2812Matrix::getColorOfBackground()
+template <uint16_t col_count, uint8_t row_count>
+CRGB clkDisplayWS2812Matrix<col_count, row_count>::getColorOfBackground()
 {
   return (bg_color);
 }
 
-void clkDisplayWS2812Matrix::setMaxPSP(uint8_t volts, uint32_t milliamps)
+template <uint16_t col_count, uint8_t row_count>
+void clkDisplayWS2812Matrix<col_count, row_count>::setMaxPSP(uint8_t volts, uint32_t milliamps)
 {
   FastLED.setMaxPowerInVoltsAndMilliamps(volts, milliamps);
 }
 
-void clkDisplayWS2812Matrix::init()
+template <uint16_t col_count, uint8_t row_count>
+void clkDisplayWS2812Matrix<col_count, row_count>::init()
 {
+#if __USE_DUAL_CORE__
+  CRGB *data = out;
+#else
+  CRGB *data = leds;
+#endif
 #if __ESPI_CHIPSET__
-  setESpiLedsData(leds, LEDS_COUNT);
+  setESpiLedsData(data, col_count * row_count);
 #else
-  setLedsData(leds, LEDS_COUNT);
+  setLedsData(data, col_count * row_count);
 #endif
+  // попиксельное сглаживание FastLED отключается, вместо него используется сглаживание яркости всего кадра
+  FastLED.setDither(DISABLE_DITHER);
 }
 
 // ===================================================
 
-clkDisplayWS2812Matrix clkDisplay(COLOR_OF_NUMBER, MX_TYPE);
+clkDisplayWS2812Matrix<MATRIX_WIDTH, MATRIX_HEIGHT> clkDisplay(COLOR_OF_NUMBER, MX_TYPE);
@@ -0,0 +1,320 @@
+/**
+ * @file clkEventBus.h
+ * @author Vladimir Shatalov (valesh-soft@yandex.ru)
+ *
+ * @brief очередь событий часов, в том числе из обработчиков прерываний
+ *
+ * @version 1.0
+ * @date 19.10.2026
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#pragma once
+#include <Arduino.h>
+
+// ==== clkEventBus ==================================
+
+/*
+ * источники событий (опрос кнопок, RTC, датчики, обработчики прерываний)
+ * помещают их в кольцевой буфер фиксированного размера, а shSimpleClock::tick()
+ * раздает накопленные события подписчикам; так задачи реагируют только на
+ * изменения вместо того, чтобы проверять общие флаги при каждом срабатывании;
+ *
+ * событие занимает два байта - тип и аргумент; подписчик задается маской
+ * типов событий; если буфер переполнен, новое событие отбрасывается и
+ * учитывается счетчиком потерь, а наибольшее заполнение буфера помогает
+ * подобрать EVENT_QUEUE_SIZE
+ */
+
+#if !defined(EVENT_QUEUE_SIZE)
+#define EVENT_QUEUE_SIZE 8 // размер очереди событий
+#endif
+
+#if !defined(EVENT_HANDLER_COUNT)
+#define EVENT_HANDLER_COUNT 2 // максимальное количество пользовательских подписчиков на события
+#endif
+
+enum clkEventType : uint8_t
+{
+  CLK_EV_NEW_SECOND, // смена секунды; аргумент - текущая секунда
+  CLK_EV_MODE,       // смена режима экрана; аргумент - новый режим (clkDisplayMode)
+  CLK_EV_BUTTON,     // событие кнопки; аргумент - CLK_EV_BUTTON_ARG(кнопка, событие)
+  CLK_EV_ALARM,      // срабатывание будильника
+  CLK_EV_SENSOR,     // обновление данных датчика; аргумент - clkSensorType
+  CLK_EV_USER1,      // пользовательские события
+  CLK_EV_USER2,
+  CLK_EV_USER3
+};
+
+enum clkSensorType : uint8_t
+{
+  CLK_SENSOR_TEMP,
+  CLK_SENSOR_LIGHT
+};
+
+// маска подписки на событие заданного типа
+#define CLK_EV_MASK(type) ((uint8_t)(1 << (type)))
+#define CLK_EV_ALL 0xFF
+
+// аргумент события кнопки: старшие четыре бита - кнопка (clkButtonType), младшие - событие (BTN_DOWN и т.д.)
+#define CLK_EV_BUTTON_ARG(btn, state) ((uint8_t)(((btn) << 4) | ((state)&0x0F)))
+#define CLK_EV_BUTTON_ID(arg) ((uint8_t)((arg) >> 4))
+#define CLK_EV_BUTTON_STATE(arg) ((uint8_t)((arg)&0x0F))
+
+struct clkEvent
+{
+  clkEventType type;
+  uint8_t arg;
+};
+
+typedef void (*clkEventHandler)(clkEvent _event); // тип - указатель на функцию-подписчика
+
+/*
+ * запрет прерываний на время работы с индексами очереди; прежнее состояние
+ * восстанавливается, поэтому блокировку можно брать и внутри обработчика
+ * прерывания
+ */
+class clkIrqLock
+{
+private:
+#if defined(__AVR__)
+  uint8_t sreg;
+#elif defined(ARDUINO_ARCH_ESP32)
+  static portMUX_TYPE &mux()
+  {
+    static portMUX_TYPE m = portMUX_INITIALIZER_UNLOCKED;
+    return (m);
+  }
+#elif defined(ARDUINO_ARCH_ESP8266)
+  uint32_t ps;
+#elif defined(__arm__)
+  uint32_t primask;
+#endif
+
+public:
+  clkIrqLock()
+  {
+#if defined(__AVR__)
+    sreg = SREG;
+    cli();
+#elif defined(ARDUINO_ARCH_ESP32)
+    portENTER_CRITICAL_SAFE(&mux());
+#elif defined(ARDUINO_ARCH_ESP8266)
+    ps = xt_rsil(15);
+#elif defined(__arm__)
+    __asm__ volatile("mrs %0, primask\n\tcpsid i" : "=r"(primask) : : "memory");
+#else
+    noInterrupts();
+#endif
+  }
+
+  ~clkIrqLock()
+  {
+#if defined(__AVR__)
+    SREG = sreg;
+#elif defined(ARDUINO_ARCH_ESP32)
+    portEXIT_CRITICAL_SAFE(&mux());
+#elif defined(ARDUINO_ARCH_ESP8266)
+    xt_wsr_ps(ps);
+#elif defined(__arm__)
+    __asm__ volatile("msr primask, %0" : : "r"(primask) : "memory");
+#else
+    interrupts();
+#endif
+  }
+};
+
+template <uint8_t SIZE, uint8_t HANDLERS>
+class clkEventBus
+{
+private:
+  static_assert(SIZE >= 2 && SIZE <= 128, "the event queue size must be in the range 2..128");
+  static_assert(HANDLERS >= 1, "at least one event handler slot is required");
+
+  clkEvent queue[SIZE];
+  volatile uint8_t head = 0;      // ячейка для следующего события
+  volatile uint8_t tail = 0;      // самое старое событие
+  volatile uint8_t count = 0;     // количество событий в очереди
+  volatile uint8_t high_mark = 0; // наибольшее количество событий в очереди
+  volatile uint16_t dropped = 0;  // количество отброшенных событий
+
+  uint8_t mask[HANDLERS];
+  clkEventHandler handler[HANDLERS];
+
+public:
+  clkEventBus()
+  {
+    for (uint8_t i = 0; i < HANDLERS; i++)
+    {
+      mask[i] = 0;
+      handler[i] = nullptr;
+    }
+  }
+
+  /**
+   * @brief помещение события в очередь; можно вызывать из обработчика прерывания
+   *
+   * @param _type тип события
+   * @param _arg аргумент события
+   * @return false, если очередь переполнена и событие отброшено
+   */
+  bool post(clkEventType _type, uint8_t _arg = 0);
+
+  /**
+   * @brief извлечение самого старого события из очереди
+   *
+   * @param _event сюда записывается событие
+   * @return false, если очередь пуста
+   */
+  bool get(clkEvent &_event);
+
+  /**
+   * @brief раздача всех накопленных событий подписчикам; вызывается из shSimpleClock::tick()
+   *
+   */
+  void dispatch();
+
+  /**
+   * @brief подписка на события
+   *
+   * @param _mask маска типов событий, например CLK_EV_MASK(CLK_EV_BUTTON) | CLK_EV_MASK(CLK_EV_ALARM)
+   * @param _handler вызываемая функция
+   * @return false, если свободных мест для подписчиков нет
+   */
+  bool addHandler(uint8_t _mask, clkEventHandler _handler);
+
+  void removeHandler(clkEventHandler _handler);
+
+  /**
+   * @brief количество событий, отброшенных из-за переполнения очереди
+   *
+   * @return uint16_t
+   */
+  uint16_t getDroppedCount() { return (dropped); }
+
+  /**
+   * @brief наибольшее количество событий, одновременно находившихся в очереди
+   *
+   * @return uint8_t
+   */
+  uint8_t getHighWaterMark() { return (high_mark); }
+
+  /**
+   * @brief сброс счетчиков потерь и наибольшего заполнения
+   *
+   */
+  void clearStats();
+};
+
+// ---- clkEventBus public ----------------------
+
+template <uint8_t SIZE, uint8_t HANDLERS>
+bool clkEventBus<SIZE, HANDLERS>::post(clkEventType _type, uint8_t _arg)
+{
+  clkIrqLock lock;
+  if (count >= SIZE)
+  {
+    if (dropped < 0xFFFF)
+    {
+      dropped++;
+    }
+    return (false);
+  }
+
+  queue[head].type = _type;
+  queue[head].arg = _arg;
+  head = (head + 1) % SIZE;
+  if (++count > high_mark)
+  {
+    high_mark = count;
+  }
+  return (true);
+}
+
+template <uint8_t SIZE, uint8_t HANDLERS>
+bool clkEventBus<SIZE, HANDLERS>::get(clkEvent &_event)
+{
+  clkIrqLock lock;
+  if (count == 0)
+  {
+    return (false);
+  }
+
+  _event = queue[tail];
+  tail = (tail + 1) % SIZE;
+  count--;
+  return (true);
+}
+
+template <uint8_t SIZE, uint8_t HANDLERS>
+void clkEventBus<SIZE, HANDLERS>::dispatch()
+{
+  // раздаются только события, которые уже были в очереди, - события,
+  // порожденные подписчиками, будут розданы при следующем вызове
+  uint8_t n = count;
+  clkEvent ev;
+  while (n-- > 0 && get(ev))
+  {
+    for (uint8_t i = 0; i < HANDLERS; i++)
+    {
+      if (handler[i] != nullptr && (mask[i] & CLK_EV_MASK(ev.type)))
+      {
+        handler[i](ev);
+      }
+    }
+  }
+}
+
+template <uint8_t SIZE, uint8_t HANDLERS>
+bool clkEventBus<SIZE, HANDLERS>::addHandler(uint8_t _mask, clkEventHandler _handler)
+{
+  // повторная подписка только меняет маску, поэтому сначала ищется уже
+  // существующая подписка - она может оказаться и после свободного места
+  uint8_t slot = HANDLERS;
+  for (uint8_t i = 0; i < HANDLERS; i++)
+  {
+    if (handler[i] == _handler)
+    {
+      slot = i;
+      break;
+    }
+    if (handler[i] == nullptr && slot == HANDLERS)
+    {
+      slot = i;
+    }
+  }
+  if (slot == HANDLERS)
+  {
+    return (false);
+  }
+
+  mask[slot] = _mask;
+  handler[slot] = _handler;
+  return (true);
+}
+
+template <uint8_t SIZE, uint8_t HANDLERS>
+void clkEventBus<SIZE, HANDLERS>::removeHandler(clkEventHandler _handler)
+{
+  for (uint8_t i = 0; i < HANDLERS; i++)
+  {
+    if (handler[i] == _handler)
+    {
+      mask[i] = 0;
+      handler[i] = nullptr;
+    }
+  }
+}
+
+template <uint8_t SIZE, uint8_t HANDLERS>
+void clkEventBus<SIZE, HANDLERS>::clearStats()
+{
+  clkIrqLock lock;
+  dropped = 0;
+  high_mark = count;
+}
+
+// ==== end clkEventBus ==============================
+
+clkEventBus<EVENT_QUEUE_SIZE, EVENT_HANDLER_COUNT> clkEvents;
@@ -0,0 +1,113 @@
+/**
+ * @file clkFrameQueue.h
+ * @author Vladimir Shatalov (valesh-soft@yandex.ru)
+ *
+ * @brief очередь кадров для передачи между ядрами без блокировок
+ *
+ * @version 1.0
+ * @date 19.10.2026
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#pragma once
+#include <Arduino.h>
+
+// ==== clkFrameQueue ================================
+
+/*
+ * кольцевая очередь на один поставщик и одного потребителя (SPSC): ядро,
+ * на котором работает логика часов, формирует кадры, ядро вывода отправляет
+ * их на экран; индекс head меняет только поставщик, tail - только потребитель,
+ * поэтому блокировки не нужны - достаточно упорядочить запись индексов
+ * относительно записи данных (release/acquire);
+ *
+ * кадры заполняются и читаются прямо в ячейках очереди, без лишнего
+ * копирования; если очередь заполнена, новый кадр отбрасывается - экран все
+ * равно обновится следующим кадром
+ */
+
+template <class T, uint8_t SIZE>
+class clkFrameQueue
+{
+private:
+  static_assert(SIZE >= 2, "the frame queue must have at least two slots");
+
+  T slots[SIZE];
+  uint8_t head = 0;     // ячейка для следующего кадра; меняется только поставщиком
+  uint8_t tail = 0;     // ячейка для чтения; меняется только потребителем
+  uint16_t dropped = 0; // количество отброшенных кадров
+
+public:
+  clkFrameQueue() {}
+
+  /**
+   * @brief получение свободной ячейки для записи кадра; вызывается поставщиком
+   *
+   * @return T* ячейка или nullptr, если очередь заполнена (кадр засчитывается как отброшенный)
+   */
+  T *beginWrite()
+  {
+    if ((uint8_t)((head + 1) % SIZE) == __atomic_load_n(&tail, __ATOMIC_ACQUIRE))
+    {
+      if (dropped < 0xFFFF)
+      {
+        dropped++;
+      }
+      return (nullptr);
+    }
+    return (&slots[head]);
+  }
+
+  /**
+   * @brief передача заполненного кадра потребителю
+   *
+   */
+  void commitWrite()
+  {
+    __atomic_store_n(&head, (uint8_t)((head + 1) % SIZE), __ATOMIC_RELEASE);
+  }
+
+  /**
+   * @brief получение самого старого кадра; вызывается потребителем
+   *
+   * @return T* кадр или nullptr, если очередь пуста
+   */
+  T *beginRead()
+  {
+    if (__atomic_load_n(&head, __ATOMIC_ACQUIRE) == tail)
+    {
+      return (nullptr);
+    }
+    return (&slots[tail]);
+  }
+
+  /**
+   * @brief освобождение прочитанного кадра
+   *
+   */
+  void commitRead()
+  {
+    __atomic_store_n(&tail, (uint8_t)((tail + 1) % SIZE), __ATOMIC_RELEASE);
+  }
+
+  /**
+   * @brief есть ли в очереди кадры после текущего читаемого
+   *
+   * @return true
+   * @return false
+   */
+  bool hasNewer()
+  {
+    return ((uint8_t)((tail + 1) % SIZE) != __atomic_load_n(&head, __ATOMIC_ACQUIRE));
+  }
+
+  /**
+   * @brief количество отброшенных из-за переполнения кадров
+   *
+   * @return uint16_t
+   */
+  uint16_t getDroppedCount() { return (dropped); }
+};
+
+// ==== end clkFrameQueue ============================
@@ -374,34 +374,6 @@ static const uint8_t PROGMEM months[] = {
 };
 #endif
 
-/**
- * @brief Определение дня недели по дате в интервале 2000-2099 года, 0 - воскресенье
- *
- * @param _day дата
- * @param _month месяц
- * @param _year год
- * @return номер дня недели в интервале 0 (воскресенье) .. 6 (суббота)
- */
-uint8_t
-getDayOfWeek(uint8_t _day, uint8_t _month, uint16_t _year)
-{
-  static const uint8_t PROGMEM m[12] = {6, 2, 2, 5, 0, 3, 5, 1, 4, 6, 2, 4};
-
-  uint8_t y1 = _year % 2000;
-  // вычислить индекс года
-  uint8_t t1 = y1 / 12 + y1 % 12 + y1 % 12 / 4;
-  // получить индекс месяца
-  uint8_t t2 = pgm_read_byte(&m[_month - 1]);
-  // uint8_t t2 = m[_month - 1];
-  // сделать поправку на високосный год, если нужно
-  if (_month < 3 && y1 % 4 == 0)
-  {
-    t2--;
-  }
-
-  return ((t1 + t2 + _day) % 7);
-}
-
 /**
  * @brief изменение порядка следования битов в байте
  *
@@ -424,7 +396,7 @@ class clkStringData
 {
 private:
   uint8_t *data;
-  uint8_t data_count = 0;
+  uint16_t data_count = 0;
 
 public:
   clkStringData();
@@ -436,7 +408,7 @@ public:
    * символа и величины межсимвольного интервала)
    * @return возвращает true, если память для строки успешно выделена; иначе возвращает false
    */
-  bool stringInit(uint8_t _data_count);
+  bool stringInit(uint16_t _data_count);
 
   /**
    * @brief освобождение памяти, занимаемой строкой
@@ -450,7 +422,7 @@ public:
    * @param index индекс столбца
    * @return результат
    */
-  uint8_t getData(uint8_t index);
+  uint8_t getData(uint16_t index);
 
   /**
    * @brief установка битовой маски столбца
@@ -458,19 +430,19 @@ public:
    * @param index индекс столбца
    * @param _data битовая маска столбца
    */
-  void setData(uint8_t index, uint8_t _data);
+  void setData(uint16_t index, uint8_t _data);
 
   /**
    * @brief получение размера строки в столбцах
    *
    * @return результат
    */
-  uint8_t getDataLenght();
+  uint16_t getDataLenght();
 };
 
 clkStringData::clkStringData() {}
 
-bool clkStringData::stringInit(uint8_t _data_count)
+bool clkStringData::stringInit(uint16_t _data_count)
 {
   bool result = false;
   stringFree();
@@ -479,7 +451,7 @@ bool clkStringData::stringInit(uint8_t _data_count)
     data = new uint8_t[_data_count];
     if (data != NULL)
     {
-      for (uint8_t i = 0; i < _data_count; i++)
+      for (uint16_t i = 0; i < _data_count; i++)
       {
         data[i] = 0x00;
       }
@@ -502,7 +474,7 @@ void clkStringData::stringFree()
   }
 }
 
-uint8_t clkStringData::getData(uint8_t index)
+uint8_t clkStringData::getData(uint16_t index)
 {
   uint8_t result = 0;
   if (data != NULL)
@@ -512,7 +484,7 @@ uint8_t clkStringData::getData(uint8_t index)
   return (result);
 }
 
-void clkStringData::setData(uint8_t index, uint8_t _data)
+void clkStringData::setData(uint16_t index, uint8_t _data)
 
 {
   if ((data != NULL) && (index < data_count))
@@ -521,9 +493,188 @@ void clkStringData::setData(uint8_t index, uint8_t _data)
   }
 }
 
-uint8_t clkStringData::getDataLenght()
+uint16_t clkStringData::getDataLenght()
 {
   return (data_count);
 }
 
 clkStringData sData; // данные бегущей строки
+
+#if defined(USE_DIGIT_ANIMATION)
+
+uint8_t constexpr DIGIT_ANIMATION_STEPS = 8; // количество кадров анимации смены одной цифры
+
+/**
+ * @brief класс для хранения данных анимации смены цифр времени
+ *
+ */
+class clkDigitAnimation
+{
+private:
+  uint8_t old_digits[4];
+  uint8_t new_digits[4];
+  uint8_t mask = 0x00; // битовая маска изменившихся разрядов
+  uint8_t offset = 0;
+  uint8_t step = 0;
+  int8_t last_hour = -1;
+  int8_t last_minute = -1;
+
+public:
+  clkDigitAnimation();
+
+  /**
+   * @brief передача очередного выведенного на экран времени
+   *
+   * @param _offset смещение строки времени от левого края экрана
+   * @param _hour часы
+   * @param _minute минуты
+   * @return возвращает true, если хотя бы одна цифра изменилась и нужно запустить анимацию; иначе возвращает false
+   */
+  bool setTime(uint8_t _offset, int8_t _hour, int8_t _minute);
+
+  /**
+   * @brief сброс сохраненного времени; следующий вызов setTime() не запустит анимацию
+   *
+   */
+  void reset();
+
+  /**
+   * @brief переход к следующему кадру анимации
+   *
+   * @return возвращает true, если анимация еще не закончена; иначе возвращает false
+   */
+  bool nextStep();
+
+  /**
+   * @brief завершение анимации - переход к последнему кадру
+   *
+   */
+  void finish();
+
+  /**
+   * @brief получение номера текущего кадра анимации
+   *
+   * @return результат (0..DIGIT_ANIMATION_STEPS)
+   */
+  uint8_t getStep();
+
+  /**
+   * @brief проверка, изменился ли разряд
+   *
+   * @param index индекс разряда (0..3)
+   * @return true
+   * @return false
+   */
+  bool isDigitChanged(uint8_t index);
+
+  /**
+   * @brief получение индекса столбца, с которого начинается разряд
+   *
+   * @param index индекс разряда (0..3)
+   * @return результат
+   */
+  uint8_t getDigitOffset(uint8_t index);
+
+  /**
+   * @brief получение битовой маски столбца прежней цифры
+   *
+   * @param index индекс разряда (0..3)
+   * @param col столбец символа (0..5)
+   * @return результат
+   */
+  uint8_t getOldColumn(uint8_t index, uint8_t col);
+
+  /**
+   * @brief получение битовой маски столбца новой цифры
+   *
+   * @param index индекс разряда (0..3)
+   * @param col столбец символа (0..5)
+   * @return результат
+   */
+  uint8_t getNewColumn(uint8_t index, uint8_t col);
+};
+
+clkDigitAnimation::clkDigitAnimation() {}
+
+bool clkDigitAnimation::setTime(uint8_t _offset, int8_t _hour, int8_t _minute)
+{
+  bool result = false;
+
+  if (_hour < 0 || _minute < 0)
+  {
+    return (result);
+  }
+
+  if (last_hour >= 0 && last_minute >= 0 && _offset == offset &&
+      (_hour != last_hour || _minute != last_minute))
+  {
+    uint8_t o[4] = {(uint8_t)(last_hour / 10), (uint8_t)(last_hour % 10),
+                    (uint8_t)(last_minute / 10), (uint8_t)(last_minute % 10)};
+    uint8_t n[4] = {(uint8_t)(_hour / 10), (uint8_t)(_hour % 10),
+                    (uint8_t)(_minute / 10), (uint8_t)(_minute % 10)};
+    mask = 0x00;
+    for (uint8_t i = 0; i < 4; i++)
+    {
+      old_digits[i] = o[i];
+      new_digits[i] = n[i];
+      if (o[i] != n[i])
+      {
+        mask |= (1 << i);
+      }
+    }
+    step = 0;
+    result = true;
+  }
+
+  offset = _offset;
+  last_hour = _hour;
+  last_minute = _minute;
+
+  return (result);
+}
+
+void clkDigitAnimation::reset()
+{
+  last_hour = -1;
+  last_minute = -1;
+}
+
+bool clkDigitAnimation::nextStep()
+{
+  if (step < DIGIT_ANIMATION_STEPS)
+  {
+    step++;
+  }
+  return (step < DIGIT_ANIMATION_STEPS);
+}
+
+void clkDigitAnimation::finish() { step = DIGIT_ANIMATION_STEPS; }
+
+uint8_t clkDigitAnimation::getStep() { return (step); }
+
+bool clkDigitAnimation::isDigitChanged(uint8_t index)
+{
+  return ((index < 4) ? (mask >> index) & 0x01 : false);
+}
+
+uint8_t clkDigitAnimation::getDigitOffset(uint8_t index)
+{
+  // разряды строки времени: часы - offset, offset + 7; минуты - offset + 16, offset + 23
+  return (offset + index * 7 + ((index > 1) ? 2 : 0));
+}
+
+uint8_t clkDigitAnimation::getOldColumn(uint8_t index, uint8_t col)
+{
+  return ((index < 4 && col < 6) ? pgm_read_byte(&font_digit[old_digits[index] * 6 + col])
+                                 : 0x00);
+}
+
+uint8_t clkDigitAnimation::getNewColumn(uint8_t index, uint8_t col)
+{
+  return ((index < 4 && col < 6) ? pgm_read_byte(&font_digit[new_digits[index] * 6 + col])
+                                 : 0x00);
+}
+
+clkDigitAnimation sscDigitAnimation; // данные анимации смены цифр
+
+#endif
@@ -0,0 +1,327 @@
+/**
+ * @file clkRtcCalibration.h
+ * @author Vladimir Shatalov (valesh-soft@yandex.ru)
+ *
+ * @brief калибровка хода RTC по эталонному времени
+ *
+ * @version 1.0
+ * @date 19.10.2026
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#pragma once
+
+// ==== clkRtcCalibration ============================
+
+/*
+ * эталонное время (полученное по Serial, от NTP-сервера, GPS-приемника и
+ * т.д.) передается через addReference(); при каждой сверке запоминается,
+ * на сколько миллисекунд RTC ушел вперед или отстал с момента предыдущей
+ * сверки, после чего RTC устанавливается по эталону;
+ *
+ * когда суммарная длительность наблюдений в истории достигает
+ * RTC_CALIBRATION_MIN_SPAN, вычисляется дрейф (отношение суммарной ошибки
+ * хода к суммарной длительности) и вносится поправка:
+ *   DS3231  - в регистр Aging Offset (шаг около 0.1 ppm);
+ *   PCF8523 - в регистр Offset (шаг 4.34 ppm);
+ *   DS1307, PCF8563 - в программную поправку, которая хранится в EEPROM и
+ *             применяется шагами по одной секунде (см. tick());
+ * т.к. поправка меняет ход часов, после ее внесения история очищается, и
+ * следующая оценка покажет уже остаточный дрейф; история очищается и тогда,
+ * когда время RTC было установлено не через addReference() (из меню часов,
+ * методами setCurTime() и т.д.), - ошибка хода за такой период неизвестна;
+ *
+ * дрейф выражается в сотых долях ppm; положительное значение означает, что
+ * часы спешат
+ */
+
+#if !defined(RTC_CALIBRATION_MIN_SPAN)
+#define RTC_CALIBRATION_MIN_SPAN 86400ul // минимальная суммарная длительность наблюдений для оценки дрейфа, с
+#endif
+
+static const uint8_t RTC_CALIBRATION_HISTORY_SIZE = 8;
+static const uint32_t RTC_CALIBRATION_MAX_ERROR = 600ul; // расхождение больше этого (с) считается не дрейфом, а сбитыми часами
+
+struct clkDriftSample
+{
+  uint32_t time;  // время эталона на момент сверки, UTC
+  uint32_t span;  // длительность наблюдения - время с предыдущей сверки, с
+  int32_t error;  // ошибка хода RTC за время наблюдения, мс; положительное значение - часы спешат
+};
+
+class clkRtcCalibration
+{
+private:
+  clkDriftSample history[RTC_CALIBRATION_HISTORY_SIZE];
+  uint8_t count = 0;        // количество записей в истории
+  uint8_t head = 0;         // индекс ячейки для следующей записи
+  uint32_t last_sync = 0;   // время эталона при предыдущей сверке; 0 - сверок еще не было
+  int32_t base_offset = 0;  // расхождение RTC с эталоном сразу после предыдущей установки, мс
+  int32_t estimate = 0;     // последняя оценка дрейфа, 0.01 ppm
+  uint8_t set_count = 0;    // счетчик установок RTC (clkRtc::getSetCount()) после последней установки самим модулем
+#if __USE_RTC_SOFT_CALIBRATION__
+  int32_t soft_acc = 0;     // накопленная, но еще не внесенная программная поправка, 0.01 ppm * с
+  uint32_t soft_last = 0;   // время RTC (UTC) предыдущего накопления поправки
+#endif
+
+  bool updateEstimate();
+
+  void applyCorrection(int32_t _drift);
+
+public:
+  clkRtcCalibration() {}
+
+  /**
+   * @brief сверка RTC с эталонным временем; RTC после сверки устанавливается по эталону
+   *
+   * @param _utc эталонное время UTC, секунд с 01.01.1970
+   * @param _ms миллисекунды эталонного времени, если известны
+   * @return int32_t расхождение RTC с эталоном на момент сверки, мс; положительное значение - часы спешат
+   */
+  int32_t addReference(uint32_t _utc, uint16_t _ms = 0);
+
+  /**
+   * @brief получение текущей компенсируемой поправки хода
+   *
+   * @return int32_t 0.01 ppm; положительное значение - без поправки часы спешат
+   */
+  int32_t getDrift();
+
+  /**
+   * @brief получение последней оценки дрейфа по истории сверок
+   *
+   * @return int32_t 0.01 ppm
+   */
+  int32_t getEstimate();
+
+  /**
+   * @brief количество записей в истории сверок
+   *
+   * @return uint8_t
+   */
+  uint8_t getHistoryCount();
+
+  /**
+   * @brief получение записи из истории сверок
+   *
+   * @param _num номер записи, 0 - самая свежая
+   * @param _sample сюда записываются данные сверки
+   * @return false, если записи с таким номером нет
+   */
+  bool getHistory(uint8_t _num, clkDriftSample &_sample);
+
+  /**
+   * @brief очистка истории сверок; внесенные поправки сохраняются
+   *
+   */
+  void clearHistory();
+
+#if __USE_RTC_SOFT_CALIBRATION__
+  /**
+   * @brief программная коррекция хода для модулей без регистра подстройки частоты; вызывается после каждого опроса RTC
+   *
+   */
+  void tick();
+#endif
+};
+
+// ---- clkRtcCalibration private ---------------
+
+bool clkRtcCalibration::updateEstimate()
+{
+  uint32_t span = 0;
+  int32_t error = 0;
+  for (uint8_t i = 0; i < count; i++)
+  {
+    span += history[i].span;
+    error += history[i].error;
+  }
+  if (span < RTC_CALIBRATION_MIN_SPAN)
+  {
+    return (false);
+  }
+
+  // 1 мс/с = 1000 ppm = 100000 сотых ppm
+  estimate = (int64_t)error * 100000 / (int32_t)span;
+  return (true);
+}
+
+void clkRtcCalibration::applyCorrection(int32_t _drift)
+{
+  int32_t x;
+  switch (clkRtcChip::type)
+  {
+  case CLK_RTC_DS3231:
+    // единица Aging Offset замедляет ход примерно на 0.1 ppm
+    x = clkClock.getAgingOffset() + (_drift + ((_drift < 0) ? -5 : 5)) / 10;
+    clkClock.setAgingOffset((x < -128) ? -128 : ((x > 127) ? 127 : x));
+    break;
+  case CLK_RTC_PCF8523:
+    // единица Offset ускоряет ход на 4.34 ppm
+    x = clkClock.getAgingOffset() - (_drift + ((_drift < 0) ? -217 : 217)) / 434;
+    clkClock.setAgingOffset((x < -64) ? -64 : ((x > 63) ? 63 : x));
+    break;
+  default:
+#if __USE_RTC_SOFT_CALIBRATION__
+    x = getDrift() + _drift;
+    x = (x < -32767) ? -32767 : ((x > 32767) ? 32767 : x);
+    write_eeprom_16(RTC_DRIFT_EEPROM_INDEX, (uint16_t)(x + 32768));
+#endif
+    break;
+  }
+}
+
+// ---- clkRtcCalibration public ----------------
+
+int32_t clkRtcCalibration::addReference(uint32_t _utc, uint16_t _ms)
+{
+  if (_ms > 999)
+  {
+    _ms = 999;
+  }
+
+  clkClock.now();
+  if (clkClock.getSetCount() != set_count)
+  {
+    // время переустанавливалось в обход сверки - наблюдение с прошлой сверки недействительно
+    clearHistory();
+    last_sync = 0;
+  }
+  uint32_t rtc = clkClock.getCurUtc();
+  // пока RTC не отвечает, идет программное время, и его ошибка к дрейфу RTC отношения не имеет
+  bool valid = clkClock.isOnline() &&
+               ((rtc > _utc) ? (rtc - _utc < RTC_CALIBRATION_MAX_ERROR)
+                             : (_utc - rtc < RTC_CALIBRATION_MAX_ERROR));
+  int32_t result = (valid) ? (int32_t)(rtc - _utc) * 1000 + clkClock.getCurMillis() - _ms
+                           : ((rtc > _utc) ? INT32_MAX : INT32_MIN);
+
+  if (valid && last_sync != 0 && _utc > last_sync)
+  {
+    history[head].time = _utc;
+    history[head].span = _utc - last_sync;
+    history[head].error = result - base_offset;
+    head = (head + 1) % RTC_CALIBRATION_HISTORY_SIZE;
+    if (count < RTC_CALIBRATION_HISTORY_SIZE)
+    {
+      count++;
+    }
+
+    if (updateEstimate())
+    {
+      applyCorrection(estimate);
+      clearHistory();
+    }
+  }
+  else if (!valid)
+  {
+    // часы были сбиты - накопленные наблюдения больше не отражают дрейф
+    clearHistory();
+  }
+
+  // установка RTC по эталону; запись секунд перезапускает делитель RTC, поэтому
+  // до следующей сверки RTC будет отличаться от эталона на долю секунды эталона
+  if (_ms >= 500)
+  {
+    _utc++;
+    base_offset = 1000 - _ms;
+  }
+  else
+  {
+    base_offset = -(int32_t)_ms;
+  }
+  clkClock.setCurUtc(_utc);
+  set_count = clkClock.getSetCount();
+  last_sync = _utc;
+#if __USE_RTC_SOFT_CALIBRATION__
+  soft_acc = 0;
+  soft_last = _utc;
+#endif
+
+  return (result);
+}
+
+int32_t clkRtcCalibration::getDrift()
+{
+  switch (clkRtcChip::type)
+  {
+  case CLK_RTC_DS3231:
+    return ((int32_t)clkClock.getAgingOffset() * 10);
+  case CLK_RTC_PCF8523:
+    return (-(int32_t)clkClock.getAgingOffset() * 434);
+  default:
+#if __USE_RTC_SOFT_CALIBRATION__
+    return ((int32_t)read_eeprom_16(RTC_DRIFT_EEPROM_INDEX) - 32768);
+#else
+    return (0);
+#endif
+  }
+}
+
+int32_t clkRtcCalibration::getEstimate() { return (estimate); }
+
+uint8_t clkRtcCalibration::getHistoryCount() { return (count); }
+
+bool clkRtcCalibration::getHistory(uint8_t _num, clkDriftSample &_sample)
+{
+  if (_num >= count)
+  {
+    return (false);
+  }
+
+  _sample = history[(head + RTC_CALIBRATION_HISTORY_SIZE - 1 - _num) % RTC_CALIBRATION_HISTORY_SIZE];
+  return (true);
+}
+
+void clkRtcCalibration::clearHistory()
+{
+  count = 0;
+  head = 0;
+}
+
+#if __USE_RTC_SOFT_CALIBRATION__
+void clkRtcCalibration::tick()
+{
+  if (clkRtcChip::aging_reg || !clkClock.isOnline())
+  {
+    // у модуля есть регистр подстройки частоты - программная поправка не нужна
+    return;
+  }
+
+  uint32_t t = clkClock.getCurUtc();
+  if (t < soft_last || t - soft_last > 3600ul)
+  {
+    // первый вызов или время было переустановлено
+    soft_last = t;
+    return;
+  }
+  if (t - soft_last >= 60)
+  {
+    soft_acc += (int32_t)(t - soft_last) * getDrift();
+    soft_last = t;
+  }
+
+  // 1 с = 10^6 ppm * с = 10^8 сотых ppm * с; шаг делается только в начале
+  // секунды, т.к. запись секунд перезапускает делитель RTC, и фактический
+  // сдвиг равен шагу минус уже прошедшая часть секунды
+  uint16_t ms = clkClock.getCurMillis();
+  if ((soft_acc >= 100000000l || soft_acc <= -100000000l) && ms < 100)
+  {
+    int8_t step = (soft_acc > 0) ? -1 : 1;
+    bool own = (clkClock.getSetCount() == set_count);
+    clkClock.setCurUtc(t + step);
+    if (own)
+    {
+      // собственный шаг поправки не считается переустановкой времени
+      set_count = clkClock.getSetCount();
+    }
+    soft_last = t + step;
+    // сдвиг в мс переводится в сотые ppm * с
+    soft_acc += ((int32_t)step * 1000 - ms) * 100000l;
+  }
+}
+#endif
+
+// ==== end clkRtcCalibration ========================
+
+clkRtcCalibration clkRtcCal;
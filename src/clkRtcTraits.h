@@ -0,0 +1,276 @@
+/**
+ * @file clkRtcTraits.h
+ * @author Vladimir Shatalov (valesh-soft@yandex.ru)
+ *
+ * @brief описания (traits) поддерживаемых микросхем RTC и их автоопределение
+ *
+ * @version 1.0
+ * @date 19.10.2026
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#pragma once
+#include <Arduino.h>
+#include <Wire.h>
+
+// ==== clkRtcTraits =================================
+
+/*
+ * для каждой микросхемы RTC задается набор констант - адрес на шине I2C,
+ * расположение регистров времени и даты, флаг остановки генератора, бит
+ * века, наличие регистра подстройки частоты и датчика температуры;
+ * класс clkRtc параметризуется этим набором, поэтому при выборе модуля в
+ * clockSetting.h все адреса и маски подставляются на этапе компиляции;
+ *
+ * в режиме автоопределения (RTC_AUTO_DETECT) используется набор
+ * clkRtcAutoTraits с теми же полями, но изменяемыми - они заполняются
+ * при старте по результатам опроса шины
+ */
+
+enum clkRtcType : uint8_t
+{
+  CLK_RTC_DS3231,
+  CLK_RTC_DS1307,
+  CLK_RTC_PCF8563,
+  CLK_RTC_PCF8523
+};
+
+template <clkRtcType TYPE>
+struct clkRtcTraits;
+
+/*
+ * поля набора:
+ *   address      - адрес микросхемы на шине I2C;
+ *   time_reg     - первый регистр блока времени и даты (7 регистров: секунды,
+ *                  минуты, часы, затем число и день недели в порядке,
+ *                  заданном day_offset/dow_offset, месяц, год);
+ *   dow_base     - значение дня недели для воскресенья;
+ *   hour12_mask  - бит 12-часового режима в регистре часов, 0 - режима нет;
+ *   century_mask - бит века в регистре месяца, 0 - бита нет;
+ *   stop_reg     - регистр, старший бит которого - флаг остановки генератора;
+ *   aging_reg    - регистр подстройки частоты, 0 - регистра нет;
+ *   temp_reg     - первый регистр температуры, 0 - датчика нет
+ */
+
+template <>
+struct clkRtcTraits<CLK_RTC_DS3231>
+{
+  static constexpr clkRtcType type = CLK_RTC_DS3231;
+  static constexpr uint8_t address = 0x68;
+  static constexpr uint8_t time_reg = 0x00;
+  static constexpr uint8_t day_offset = 4;
+  static constexpr uint8_t dow_offset = 3;
+  static constexpr uint8_t dow_base = 1;
+  static constexpr uint8_t hour12_mask = 0x40;
+  static constexpr uint8_t century_mask = 0x80;
+  static constexpr uint8_t stop_reg = 0x0F;
+  static constexpr uint8_t aging_reg = 0x10;
+  static constexpr uint8_t temp_reg = 0x11;
+
+  static bool detect() { return (true); }
+};
+
+template <>
+struct clkRtcTraits<CLK_RTC_DS1307>
+{
+  static constexpr clkRtcType type = CLK_RTC_DS1307;
+  static constexpr uint8_t address = 0x68;
+  static constexpr uint8_t time_reg = 0x00;
+  static constexpr uint8_t day_offset = 4;
+  static constexpr uint8_t dow_offset = 3;
+  static constexpr uint8_t dow_base = 1;
+  static constexpr uint8_t hour12_mask = 0x40;
+  static constexpr uint8_t century_mask = 0x00;
+  static constexpr uint8_t stop_reg = 0x00;
+  static constexpr uint8_t aging_reg = 0x00;
+  static constexpr uint8_t temp_reg = 0x00;
+
+  static bool detect() { return (true); }
+};
+
+template <>
+struct clkRtcTraits<CLK_RTC_PCF8563>
+{
+  static constexpr clkRtcType type = CLK_RTC_PCF8563;
+  static constexpr uint8_t address = 0x51;
+  static constexpr uint8_t time_reg = 0x02;
+  static constexpr uint8_t day_offset = 3;
+  static constexpr uint8_t dow_offset = 4;
+  static constexpr uint8_t dow_base = 0;
+  static constexpr uint8_t hour12_mask = 0x00;
+  static constexpr uint8_t century_mask = 0x80;
+  static constexpr uint8_t stop_reg = 0x02;
+  static constexpr uint8_t aging_reg = 0x00;
+  static constexpr uint8_t temp_reg = 0x00;
+
+  static bool detect() { return (true); }
+};
+
+template <>
+struct clkRtcTraits<CLK_RTC_PCF8523>
+{
+  static constexpr clkRtcType type = CLK_RTC_PCF8523;
+  static constexpr uint8_t address = 0x68;
+  static constexpr uint8_t time_reg = 0x03;
+  static constexpr uint8_t day_offset = 3;
+  static constexpr uint8_t dow_offset = 4;
+  static constexpr uint8_t dow_base = 0;
+  static constexpr uint8_t hour12_mask = 0x00;
+  static constexpr uint8_t century_mask = 0x00;
+  static constexpr uint8_t stop_reg = 0x03;
+  static constexpr uint8_t aging_reg = 0x0E;
+  static constexpr uint8_t temp_reg = 0x00;
+
+  static bool detect() { return (true); }
+};
+
+// ---- автоопределение -------------------------
+
+struct clkRtcAutoTraits
+{
+  static clkRtcType type;
+  static uint8_t address;
+  static uint8_t time_reg;
+  static uint8_t day_offset;
+  static uint8_t dow_offset;
+  static uint8_t dow_base;
+  static uint8_t hour12_mask;
+  static uint8_t century_mask;
+  static uint8_t stop_reg;
+  static uint8_t aging_reg;
+  static uint8_t temp_reg;
+
+  template <class T>
+  static void bind();
+
+  static bool probe(uint8_t _address);
+
+  static uint8_t read(uint8_t _reg);
+
+  static void write(uint8_t _reg, uint8_t _data);
+
+  static bool isWritable(uint8_t _reg);
+
+  /**
+   * @brief определение подключенной микросхемы RTC; до первого вызова используется набор DS3231
+   *
+   * @return false, если ни по одному из адресов 0x51 и 0x68 никто не отвечает
+   */
+  static bool detect();
+};
+
+clkRtcType clkRtcAutoTraits::type = CLK_RTC_DS3231;
+uint8_t clkRtcAutoTraits::address = 0x68;
+uint8_t clkRtcAutoTraits::time_reg = 0x00;
+uint8_t clkRtcAutoTraits::day_offset = 4;
+uint8_t clkRtcAutoTraits::dow_offset = 3;
+uint8_t clkRtcAutoTraits::dow_base = 1;
+uint8_t clkRtcAutoTraits::hour12_mask = 0x40;
+uint8_t clkRtcAutoTraits::century_mask = 0x80;
+uint8_t clkRtcAutoTraits::stop_reg = 0x0F;
+uint8_t clkRtcAutoTraits::aging_reg = 0x10;
+uint8_t clkRtcAutoTraits::temp_reg = 0x11;
+
+template <class T>
+void clkRtcAutoTraits::bind()
+{
+  type = T::type;
+  address = T::address;
+  time_reg = T::time_reg;
+  day_offset = T::day_offset;
+  dow_offset = T::dow_offset;
+  dow_base = T::dow_base;
+  hour12_mask = T::hour12_mask;
+  century_mask = T::century_mask;
+  stop_reg = T::stop_reg;
+  aging_reg = T::aging_reg;
+  temp_reg = T::temp_reg;
+}
+
+bool clkRtcAutoTraits::probe(uint8_t _address)
+{
+  Wire.beginTransmission(_address);
+  return (Wire.endTransmission() == 0);
+}
+
+uint8_t clkRtcAutoTraits::read(uint8_t _reg)
+{
+  Wire.beginTransmission(address);
+  Wire.write(_reg);
+  Wire.endTransmission();
+  Wire.requestFrom(address, (uint8_t)1);
+  return Wire.read();
+}
+
+void clkRtcAutoTraits::write(uint8_t _reg, uint8_t _data)
+{
+  Wire.beginTransmission(address);
+  Wire.write(_reg);
+  Wire.write(_data);
+  Wire.endTransmission();
+}
+
+bool clkRtcAutoTraits::isWritable(uint8_t _reg)
+{
+  // в регистр пишется значение с измененным младшим битом, затем прежнее значение восстанавливается
+  uint8_t x = read(_reg);
+  write(_reg, x ^ 0x01);
+  bool result = (read(_reg) == (x ^ 0x01));
+  if (result)
+  {
+    write(_reg, x);
+  }
+  return (result);
+}
+
+bool clkRtcAutoTraits::detect()
+{
+  // по адресу 0x51 из поддерживаемых микросхем отвечает только PCF8563
+  if (probe(0x51))
+  {
+    bind<clkRtcTraits<CLK_RTC_PCF8563>>();
+    return (true);
+  }
+  if (!probe(0x68))
+  {
+    return (false);
+  }
+
+  // по адресу 0x68 могут отвечать DS3231, DS1307 и PCF8523; у DS3231
+  // регистр 0x11 (старший байт температуры) только для чтения, у DS1307 и
+  // PCF8523 он доступен для записи; у DS1307 есть ОЗУ до адреса 0x3F, у
+  // PCF8523 регистры заканчиваются на 0x13
+  address = 0x68;
+  if (!isWritable(0x11))
+  {
+    bind<clkRtcTraits<CLK_RTC_DS3231>>();
+  }
+  else if (isWritable(0x3F))
+  {
+    bind<clkRtcTraits<CLK_RTC_DS1307>>();
+  }
+  else
+  {
+    bind<clkRtcTraits<CLK_RTC_PCF8523>>();
+  }
+  return (true);
+}
+
+// ---- выбор набора ----------------------------
+
+#if defined(RTC_AUTO_DETECT)
+typedef clkRtcAutoTraits clkRtcChip;
+#elif defined(RTC_DS3231)
+typedef clkRtcTraits<CLK_RTC_DS3231> clkRtcChip;
+#elif defined(RTC_DS1307)
+typedef clkRtcTraits<CLK_RTC_DS1307> clkRtcChip;
+#elif defined(RTC_PCF8563)
+typedef clkRtcTraits<CLK_RTC_PCF8563> clkRtcChip;
+#elif defined(RTC_PCF8523)
+typedef clkRtcTraits<CLK_RTC_PCF8523> clkRtcChip;
+#else
+#error "Unknown RTC module specified. Set the supported RTC module in clockSetting.h"
+#endif
+
+// ==== end clkRtcTraits =============================
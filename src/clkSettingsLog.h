@@ -0,0 +1,330 @@
+/**
+ * @file clkSettingsLog.h
+ * @author Vladimir Shatalov (valesh-soft@yandex.ru)
+ *
+ * @brief журнал настроек с равномерным износом ячеек EEPROM
+ *
+ * @version 1.0
+ * @date 19.10.2026
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#pragma once
+
+// ==== clkSettingsLog ===============================
+
+/*
+ * область EEPROM, отведенная под журнал, делится на две равные страницы;
+ * каждое изменение настройки дописывается в конец активной страницы
+ * отдельной записью, поэтому ячейки изнашиваются равномерно по всей странице,
+ * а не в одном и том же месте; при старте записи активной страницы
+ * проигрываются по порядку в кэш настроек - более поздняя запись перекрывает
+ * более раннюю;
+ *
+ * когда в странице не остается места, текущие значения всех настроек одним
+ * снимком переносятся на вторую страницу (уплотнение), которая после этого
+ * становится активной;
+ *
+ * формат записи: [ключ, 2 байта][данные, 1..4 байта][CRC8], где ключ - индекс
+ * настройки в EEPROM (биты 0..11) и размер данных минус один (биты 12..13);
+ * начальное значение CRC - младший байт номера поколения страницы; запись с
+ * неверной CRC (недописанная из-за пропадания питания или оставшаяся от
+ * прежнего поколения страницы) считается концом журнала;
+ *
+ * формат заголовка страницы: [маркер][номер поколения, 4 байта][CRC8];
+ * при уплотнении сначала стирается маркер, затем пишутся снимок настроек,
+ * пустой ключ - признак конца журнала - и заголовок, маркер - последним;
+ * поэтому, если питание пропало во время уплотнения, действующей остается
+ * прежняя страница; остальные ячейки страницы не стираются - записи прежнего
+ * поколения отсекаются проверкой CRC; номер поколения увеличивается при
+ * каждом уплотнении и заодно является счетчиком уплотнений; страницы
+ * перезаписываются поочередно, т.е. каждая ячейка журнала перезаписывается
+ * при уплотнении примерно вдвое реже;
+ *
+ * журнал имеет смысл только для настоящей EEPROM с побайтной записью (AVR);
+ * при эмуляции EEPROM во флеш-памяти любое изменение приводит к стиранию
+ * всего сектора, и распределение записи по ячейкам ничего не дает
+ */
+
+#if !defined(SETTINGS_LOG_START_INDEX)
+#define SETTINGS_LOG_START_INDEX 112
+#endif
+#if !defined(SETTINGS_LOG_SIZE)
+#define SETTINGS_LOG_SIZE 256
+#endif
+
+static const uint8_t SETTINGS_LOG_MARKER = 0xA5;
+static const uint8_t SETTINGS_LOG_HEADER_SIZE = 6;
+static const uint16_t SETTINGS_LOG_PAGE_SIZE = SETTINGS_LOG_SIZE / 2;
+static const uint16_t SETTINGS_LOG_EMPTY_KEY = 0xFFFF;
+
+// в странице должны поместиться заголовок, снимок всех настроек и хотя бы одна запись сверх него
+static_assert(SETTINGS_LOG_PAGE_SIZE >= SETTINGS_LOG_HEADER_SIZE +
+                                            sizeof(clkSettingsData) + SETTINGS_ITEM_COUNT * 3 + 7,
+              "SETTINGS_LOG_SIZE is too small for the current set of settings");
+static_assert(SETTINGS_ITEM_COUNT <= 32, "too many settings for the settings log");
+#if defined(E2END)
+static_assert(SETTINGS_LOG_START_INDEX + SETTINGS_LOG_SIZE <= E2END + 1,
+              "the settings log region does not fit the EEPROM of this microcontroller");
+#endif
+// под индекс настройки в ключе записи отведено 12 бит
+static_assert(SETTINGS_LOG_START_INDEX + SETTINGS_LOG_SIZE <= 4096,
+              "the settings log region must lie within the first 4096 bytes of EEPROM");
+
+class clkSettingsLog
+{
+private:
+  uint16_t page = SETTINGS_LOG_START_INDEX; // индекс первой ячейки активной страницы
+  uint16_t pos = SETTINGS_LOG_START_INDEX;  // индекс ячейки для следующей записи
+  uint32_t generation = 0;                  // номер поколения активной страницы
+  uint32_t logical_bytes = 0;               // объем изменившихся данных настроек с момента старта, байт
+  uint32_t physical_bytes = 0;              // объем реально измененных ячеек EEPROM с момента старта, байт
+  bool complete = false;                    // при загрузке в журнале нашлись все настройки
+
+  void write(uint16_t _index, uint8_t _data);
+
+  bool readHeader(uint16_t _page, uint32_t &_gen);
+
+  uint16_t writeRecord(uint16_t _pos, clkSettingItem &_item);
+
+  void compact();
+
+public:
+  clkSettingsLog() {}
+
+  /**
+   * @brief загрузка настроек из журнала в кэш настроек
+   *
+   * @return false, если в EEPROM нет ни одной действующей страницы журнала
+   */
+  bool load();
+
+  /**
+   * @brief нашлись ли при загрузке в журнале значения всех настроек текущей конфигурации
+   *
+   * @return true
+   * @return false
+   */
+  bool isComplete();
+
+  /**
+   * @brief создание журнала из текущего содержимого кэша настроек; используется при первом старте, в т.ч. для переноса настроек с фиксированных адресов EEPROM
+   *
+   */
+  void format();
+
+  /**
+   * @brief добавление в журнал записи с текущим значением настройки из кэша
+   *
+   * @param _item описание настройки
+   */
+  void append(clkSettingItem &_item);
+
+  /**
+   * @brief количество уплотнений журнала с момента его создания (номер поколения активной страницы)
+   *
+   * @return uint32_t
+   */
+  uint32_t getCompactionCount();
+
+  /**
+   * @brief объем изменившихся данных настроек с момента старта
+   *
+   * @return uint32_t
+   */
+  uint32_t getLogicalBytes();
+
+  /**
+   * @brief количество ячеек EEPROM, реально перезаписанных журналом с момента старта
+   *
+   * @return uint32_t
+   */
+  uint32_t getPhysicalBytes();
+};
+
+// ---- clkSettingsLog private ------------------
+
+void clkSettingsLog::write(uint16_t _index, uint8_t _data)
+{
+  if (eeprom_read(_index) != _data)
+  {
+    eeprom_update(_index, _data);
+    physical_bytes++;
+  }
+}
+
+bool clkSettingsLog::readHeader(uint16_t _page, uint32_t &_gen)
+{
+  if (eeprom_read(_page) != SETTINGS_LOG_MARKER)
+  {
+    return (false);
+  }
+
+  uint8_t crc = settings_crc8(0, SETTINGS_LOG_MARKER);
+  _gen = 0;
+  for (uint8_t i = 0; i < 4; i++)
+  {
+    uint8_t x = eeprom_read(_page + 1 + i);
+    crc = settings_crc8(crc, x);
+    _gen |= (uint32_t)x << (i * 8);
+  }
+
+  return (crc == eeprom_read(_page + 5));
+}
+
+uint16_t clkSettingsLog::writeRecord(uint16_t _pos, clkSettingItem &_item)
+{
+  uint16_t key = _item.index | ((uint16_t)(_item.size - 1) << 12);
+  uint8_t *p = (uint8_t *)&clk_settings + _item.offset;
+
+  write(_pos++, lowByte(key));
+  write(_pos++, highByte(key));
+  uint8_t crc = settings_crc8(settings_crc8((uint8_t)generation, lowByte(key)), highByte(key));
+  for (uint8_t i = 0; i < _item.size; i++)
+  {
+    write(_pos++, p[i]);
+    crc = settings_crc8(crc, p[i]);
+  }
+  write(_pos++, crc);
+
+  return (_pos);
+}
+
+void clkSettingsLog::compact()
+{
+  uint16_t next = (page == SETTINGS_LOG_START_INDEX) ? SETTINGS_LOG_START_INDEX + SETTINGS_LOG_PAGE_SIZE
+                                                     : SETTINGS_LOG_START_INDEX;
+
+  // маркер стирается первым, чтобы недописанная страница не считалась действующей
+  write(next, 0xFF);
+
+  // снимок всех настроек; записи защищаются CRC уже с новым номером поколения
+  generation++;
+  uint16_t p = next + SETTINGS_LOG_HEADER_SIZE;
+  for (uint8_t i = 0; i < SETTINGS_ITEM_COUNT; i++)
+  {
+    clkSettingItem item;
+    memcpy_P(&item, &settings_items[i], sizeof(clkSettingItem));
+    p = writeRecord(p, item);
+  }
+  if (p + 2 <= next + SETTINGS_LOG_PAGE_SIZE)
+  {
+    write(p, lowByte(SETTINGS_LOG_EMPTY_KEY));
+    write(p + 1, highByte(SETTINGS_LOG_EMPTY_KEY));
+  }
+
+  // заголовок - последним
+  uint8_t crc = settings_crc8(0, SETTINGS_LOG_MARKER);
+  for (uint8_t i = 0; i < 4; i++)
+  {
+    uint8_t x = (uint8_t)(generation >> (i * 8));
+    write(next + 1 + i, x);
+    crc = settings_crc8(crc, x);
+  }
+  write(next + 5, crc);
+  write(next, SETTINGS_LOG_MARKER);
+
+  page = next;
+  pos = p;
+}
+
+// ---- clkSettingsLog public -------------------
+
+bool clkSettingsLog::load()
+{
+  uint32_t gen_a, gen_b;
+  bool valid_a = readHeader(SETTINGS_LOG_START_INDEX, gen_a);
+  bool valid_b = readHeader(SETTINGS_LOG_START_INDEX + SETTINGS_LOG_PAGE_SIZE, gen_b);
+  if (!valid_a && !valid_b)
+  {
+    return (false);
+  }
+
+  // если действующих страниц две (питание пропало сразу после уплотнения), берется более новая
+  if (valid_a && valid_b)
+  {
+    valid_a = (int32_t)(gen_a - gen_b) > 0;
+  }
+  page = (valid_a) ? SETTINGS_LOG_START_INDEX : SETTINGS_LOG_START_INDEX + SETTINGS_LOG_PAGE_SIZE;
+  generation = (valid_a) ? gen_a : gen_b;
+
+  // настройки, которых нет в журнале, получат значение стертой ячейки и будут исправлены при валидации
+  memset(&clk_settings, 0xFF, sizeof(clkSettingsData));
+  uint32_t found = 0;
+
+  uint16_t end = page + SETTINGS_LOG_PAGE_SIZE;
+  pos = page + SETTINGS_LOG_HEADER_SIZE;
+  while (pos + 4 <= end)
+  {
+    uint16_t key = eeprom_read(pos) | (eeprom_read(pos + 1) << 8);
+    uint8_t size = ((key >> 12) & 0x03) + 1;
+    if (key == SETTINGS_LOG_EMPTY_KEY || pos + size + 3 > end)
+    {
+      break;
+    }
+
+    uint8_t data[4];
+    uint8_t crc = settings_crc8(settings_crc8((uint8_t)generation, lowByte(key)), highByte(key));
+    for (uint8_t i = 0; i < size; i++)
+    {
+      data[i] = eeprom_read(pos + 2 + i);
+      crc = settings_crc8(crc, data[i]);
+    }
+    if (crc != eeprom_read(pos + 2 + size))
+    {
+      break;
+    }
+
+    // записи настроек, которых нет в текущей конфигурации, пропускаются
+    for (uint8_t i = 0; i < SETTINGS_ITEM_COUNT; i++)
+    {
+      clkSettingItem item;
+      memcpy_P(&item, &settings_items[i], sizeof(clkSettingItem));
+      if (item.index == (key & 0x0FFF) && item.size == size)
+      {
+        memcpy((uint8_t *)&clk_settings + item.offset, data, size);
+        found |= 1ul << i;
+        break;
+      }
+    }
+    pos += size + 3;
+  }
+  complete = (found == (uint32_t)((1ull << SETTINGS_ITEM_COUNT) - 1));
+
+  return (true);
+}
+
+bool clkSettingsLog::isComplete() { return (complete); }
+
+void clkSettingsLog::format()
+{
+  complete = true;
+  // уплотнение всегда пишет в неактивную страницу, поэтому первой будет заполнена страница А
+  page = SETTINGS_LOG_START_INDEX + SETTINGS_LOG_PAGE_SIZE;
+  generation = 0;
+  compact();
+}
+
+void clkSettingsLog::append(clkSettingItem &_item)
+{
+  logical_bytes += _item.size;
+  if (pos + _item.size + 3 > page + SETTINGS_LOG_PAGE_SIZE)
+  {
+    compact(); // новое значение уже есть в кэше и попадет в снимок
+  }
+  else
+  {
+    pos = writeRecord(pos, _item);
+  }
+}
+
+uint32_t clkSettingsLog::getCompactionCount() { return (generation); }
+
+uint32_t clkSettingsLog::getLogicalBytes() { return (logical_bytes); }
+
+uint32_t clkSettingsLog::getPhysicalBytes() { return (physical_bytes); }
+
+// ==== end clkSettingsLog ===========================
+
+clkSettingsLog clkSetLog;
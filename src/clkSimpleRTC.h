@@ -12,25 +12,56 @@
 #include <Arduino.h>
 #include <Wire.h>
 
-#if defined(RTC_PCF8563)
-#define CLOCK_ADDRESS 0x51
-#else
-#define CLOCK_ADDRESS 0x68
-#endif
+#include "clkRtcTraits.h"
 
 #define SECONDS_FROM_1970_TO_2000 946684800
+#define SECONDS_PER_DAY 86400ul
 
 static const uint8_t daysInMonth[] PROGMEM = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
 
+/**
+ * @brief проверка, является ли год високосным (по правилам григорианского календаря)
+ *
+ * @param _year год, например, 2024
+ * @return true
+ * @return false
+ */
+bool isLeapYear(uint16_t _year)
+{
+  return ((_year % 4 == 0 && _year % 100 != 0) || _year % 400 == 0);
+}
+
+/**
+ * @brief количество дней в месяце
+ *
+ * @param _month месяц (1..12)
+ * @param _year год, например, 2024
+ * @return uint8_t
+ */
+uint8_t getDaysInMonth(uint8_t _month, uint16_t _year)
+{
+  uint8_t result = pgm_read_byte(&daysInMonth[_month - 1]);
+  if (_month == 2 && isLeapYear(_year))
+  {
+    result++;
+  }
+  return (result);
+}
+
 // ==== clkDateTime ===================================
 
 // Простой класс даты/времени общего назначения (без обработки TZ/DST/дополнительных секунд!)
 // на основе класса DateTime от JeeLabs/Adafruit
+//
+// год хранится полностью (например, 2024); високосные годы определяются по
+// правилам григорианского календаря; время unixtime() представимо в
+// интервале с 01.01.1970 по 07.02.2106
 class clkDateTime
 {
 public:
   clkDateTime(uint32_t t = 0);
 
+  // год можно задавать как полностью (2024), так и двумя цифрами (24) - тогда он считается годом 21 века
   clkDateTime(uint16_t year, uint8_t month, uint8_t day,
              uint8_t hour = 0, uint8_t min = 0, uint8_t sec = 0);
 
@@ -60,69 +91,82 @@ public:
   void copyDateTime(const clkDateTime &_source);
 
 protected:
-  uint8_t yOff, m, d, hh, mm, ss;
+  uint16_t y;
+  uint8_t m, d, hh, mm, ss;
 
 private:
-  static uint16_t date2days(uint16_t y, uint8_t m, uint8_t d);
+  static uint32_t date2days(uint16_t y, uint8_t m, uint8_t d);
+
+  static void days2date(uint32_t days, uint16_t &y, uint8_t &m, uint8_t &d);
 
-  static long time2long(uint16_t days, uint8_t h, uint8_t m, uint8_t s);
+  static uint32_t time2long(uint32_t days, uint8_t h, uint8_t m, uint8_t s);
 };
 
 // ---- clkDateTime private ------------------------
 
-uint16_t clkDateTime::date2days(uint16_t y, uint8_t m, uint8_t d)
+/*
+ * преобразования дата <-> количество дней с 01.01.1970 выполняются без циклов
+ * по годам и месяцам (алгоритмы days_from_civil/civil_from_days Г. Хиннанта);
+ * год условно начинается с 1 марта, поэтому 29 февраля оказывается последним
+ * днем года, а длины месяцев с марта по январь описываются формулой
+ * (153 * m + 2) / 5; все вычисления беззнаковые и точны для григорианского
+ * календаря начиная с 01.03.0000
+ */
+
+// количество дней с 01.01.1970 до заданной даты
+uint32_t clkDateTime::date2days(uint16_t y, uint8_t m, uint8_t d)
 {
-  if (y >= 2000)
-    y -= 2000;
-  uint16_t days = d;
-  for (uint8_t i = 1; i < m; ++i)
-    days += pgm_read_byte(daysInMonth + i - 1);
-  if (m > 2 && y % 4 == 0)
-    ++days;
-  return days + 365 * y + (y + 3) / 4 - 1;
+  if (m <= 2)
+  {
+    y--;
+  }
+  uint16_t era = y / 400;                                        // номер 400-летнего цикла
+  uint16_t yoe = y - era * 400;                                  // год цикла, [0, 399]
+  uint16_t doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1; // день года, отсчитываемого от 1 марта, [0, 365]
+  uint32_t doe = 365ul * yoe + yoe / 4 - yoe / 100 + doy;        // день цикла, [0, 146096]
+
+  return (era * 146097ul + doe - 719468ul); // 719468 - количество дней с 01.03.0000 до 01.01.1970
 }
 
-long clkDateTime::time2long(uint16_t days, uint8_t h, uint8_t m, uint8_t s)
+// дата по количеству дней с 01.01.1970
+void clkDateTime::days2date(uint32_t days, uint16_t &y, uint8_t &m, uint8_t &d)
 {
-  return ((days * 24L + h) * 60 + m) * 60 + s;
+  days += 719468ul;
+  uint16_t era = days / 146097ul;
+  uint32_t doe = days - era * 146097ul;
+  uint16_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+  uint16_t doy = doe - (365ul * yoe + yoe / 4 - yoe / 100);
+  uint8_t mp = (5 * doy + 2) / 153;
+
+  d = doy - (153 * mp + 2) / 5 + 1;
+  m = (mp < 10) ? mp + 3 : mp - 9;
+  y = yoe + era * 400 + (m <= 2);
+}
+
+uint32_t clkDateTime::time2long(uint32_t days, uint8_t h, uint8_t m, uint8_t s)
+{
+  return (days * SECONDS_PER_DAY + (h * 60u + m) * 60ul + s);
 }
 
 // ---- clkDateTime public -------------------------
 
 clkDateTime::clkDateTime(uint32_t t)
 {
-  t -= SECONDS_FROM_1970_TO_2000; // переместить точку времени с 1970 года на 2000
+  uint32_t days = t / SECONDS_PER_DAY;
+  t -= days * SECONDS_PER_DAY;
 
-  ss = t % 60;
-  t /= 60;
-  mm = t % 60;
-  t /= 60;
-  hh = t % 24;
-  uint16_t days = t / 24;
-  uint8_t leap;
-  for (yOff = 0;; ++yOff)
-  {
-    leap = yOff % 4 == 0;
-    if (days < 365u + leap)
-      break;
-    days -= 365 + leap;
-  }
-  for (m = 1;; ++m)
-  {
-    uint8_t daysPerMonth = pgm_read_byte(daysInMonth + m - 1);
-    if (leap && m == 2)
-      ++daysPerMonth;
-    if (days < daysPerMonth)
-      break;
-    days -= daysPerMonth;
-  }
-  d = days + 1;
+  hh = t / 3600;
+  t -= hh * 3600ul;
+  mm = t / 60;
+  ss = t - mm * 60u;
+
+  days2date(days, y, m, d);
 }
 
 clkDateTime::clkDateTime(uint16_t year, uint8_t month, uint8_t day,
                        uint8_t hour, uint8_t min, uint8_t sec)
 {
-  yOff = year % 100;
+  y = (year < 100) ? year + 2000 : year;
   m = (month <= 12 && month > 0) ? month : 1;
   d = (day <= 31 && day > 0) ? day : 1;
   hh = (hour <= 23) ? hour : 0;
@@ -130,16 +174,27 @@ clkDateTime::clkDateTime(uint16_t year, uint8_t month, uint8_t day,
   ss = (sec <= 59) ? sec : 0;
 }
 
-clkDateTime::clkDateTime(const clkDateTime &copy) : yOff(copy.yOff), m(copy.m), d(copy.d),
+clkDateTime::clkDateTime(const clkDateTime &copy) : y(copy.y), m(copy.m), d(copy.d),
                                                  hh(copy.hh), mm(copy.mm), ss(copy.ss) {}
 
-uint16_t clkDateTime::year() const { return yOff; }
+uint16_t clkDateTime::year() const { return y; }
 uint8_t clkDateTime::month() const { return m; }
 uint8_t clkDateTime::day() const { return d; }
 uint8_t clkDateTime::hour() const { return hh; }
 uint8_t clkDateTime::minute() const { return mm; }
 uint8_t clkDateTime::second() const { return ss; }
 
+uint8_t clkDateTime::dayOfTheWeek() const
+{
+  // 01.01.1970 - четверг
+  return ((date2days(y, m, d) + 4) % 7);
+}
+
+long clkDateTime::secondstime() const
+{
+  return (unixtime() - SECONDS_FROM_1970_TO_2000);
+}
+
 /*
  * 32-битное время в секундах с 01.01.1970
  *
@@ -149,17 +204,12 @@ uint8_t clkDateTime::second() const { return ss; }
  */
 uint32_t clkDateTime::unixtime(void) const
 {
-  uint32_t t;
-  uint16_t days = date2days(yOff, m, d);
-  t = time2long(days, hh, mm, ss);
-  t += SECONDS_FROM_1970_TO_2000; // seconds from 1970 to 2000
-
-  return t;
+  return (time2long(date2days(y, m, d), hh, mm, ss));
 }
 
 void clkDateTime::copyDateTime(const clkDateTime &_source)
 {
-  yOff = _source.yOff;
+  y = _source.y;
   m = _source.m;
   d = _source.d;
   hh = _source.hh;
@@ -169,12 +219,90 @@ void clkDateTime::copyDateTime(const clkDateTime &_source)
 
 // ==== end clkDateTime ===============================
 
-// ==== clkSimpleRTC ==================================
+#if defined(USE_TIME_ZONE)
+#include "clkTimeZone.h"
+#endif
+
+// ==== clkRtc =======================================
 
-class clkSimpleRTC
+/*
+ * класс параметризуется набором свойств микросхемы (см. clkRtcTraits.h);
+ * различия микросхем описаны константами набора, поэтому при выборе
+ * модуля в clockSetting.h проверки свойств сворачиваются компилятором, а
+ * в режиме автоопределения выполняются по значениям, найденным при старте
+ */
+
+/*
+ * если RTC перестает отвечать (или возвращает заведомо неверные данные),
+ * время продолжает идти программно - от последнего прочитанного значения
+ * по millis(); повторные попытки связи с RTC делаются не при каждом опросе,
+ * а с интервалом, который после каждой неудачи удваивается от
+ * RTC_RETRY_MIN_INTERVAL до RTC_RETRY_MAX_INTERVAL, поэтому отключенный
+ * модуль не занимает шину I2C; когда RTC снова отвечает, опрос
+ * возобновляется, а если модуль за это время потерял питание, в него
+ * записывается программное время
+ */
+
+#define CLOCK_TIME_REGISTER_COUNT 7
+
+/*
+ * календарь ведется приращениями: при каждом опросе из RTC читается только
+ * регистр секунд, и если секунда сменилась внутри минуты, текущее время
+ * просто сдвигается на секунду; весь блок времени и даты читается при смене
+ * минуты или при скачке времени; день недели вычисляется только при смене
+ * даты; по итогам опроса выставляются флаги пересеченных границ (новая
+ * секунда, минута, час, сутки), чтобы потребителям не нужно было сравнивать
+ * время с предыдущим самостоятельно
+ */
+
+enum clkRollover : uint8_t
+{
+  CLK_NEW_SECOND = 0x01,
+  CLK_NEW_MINUTE = 0x02,
+  CLK_NEW_HOUR = 0x04,
+  CLK_NEW_DAY = 0x08
+};
+
+#if !defined(RTC_RETRY_MIN_INTERVAL)
+#define RTC_RETRY_MIN_INTERVAL 500u // первый интервал повторной попытки связи с RTC, мс
+#endif
+#if !defined(RTC_RETRY_MAX_INTERVAL)
+#define RTC_RETRY_MAX_INTERVAL 32000u // максимальный интервал повторной попытки связи с RTC, мс
+#endif
+
+template <class CHIP>
+class clkRtc
 {
 private:
   clkDateTime cur_time;
+  uint32_t cur_utc = SECONDS_FROM_1970_TO_2000; // время UTC последнего опроса RTC, секунд с 01.01.1970
+  uint8_t cur_dow = 6;         // день недели cur_time, 0 - воскресенье; 01.01.2000 - суббота
+  uint8_t rollover = 0;        // флаги границ, пересеченных при последнем опросе (clkRollover)
+  bool synced = false;         // соответствует ли cur_time блоку времени и даты RTC
+  unsigned long sec_edge = 0;  // оценка момента (по millis()) начала текущей секунды RTC
+  unsigned long last_poll = 0; // момент предыдущего опроса RTC
+  bool edge_sync = false;      // ждать ли начала следующей секунды перед изменением части даты/времени
+  uint8_t set_count = 0;       // счетчик установок времени RTC
+
+  bool online = true;              // отвечает ли RTC
+  uint16_t retry_interval = 0;     // текущий интервал повторных попыток связи с RTC, мс
+  unsigned long retry_time = 0;    // момент последней неудачной попытки связи
+  uint16_t error_count = 0;        // количество неудачных обращений к RTC
+  uint16_t outage_count = 0;       // сколько раз RTC переставал отвечать
+  uint32_t soft_utc = SECONDS_FROM_1970_TO_2000; // программное время UTC, секунд с 01.01.1970
+  unsigned long soft_start = 0;    // момент (по millis()) начала секунды soft_utc
+
+  void syncSecondEdge(bool _changed);
+
+  void updateCalendar(const clkDateTime &_prev, bool _notify);
+
+  void readError();
+
+  void setSoftTime(uint32_t _utc);
+
+  void softNow();
+
+  void updateLocalTime();
 
   uint8_t decToBcd(uint8_t val);
   uint8_t bcdToDec(uint8_t val);
@@ -185,19 +313,75 @@ private:
 
   void write_register(uint8_t reg, uint8_t data);
 
+  bool read_burst(uint8_t reg, uint8_t *data, uint8_t count);
+
+  void write_burst(uint8_t reg, const uint8_t *data, uint8_t count);
+
+  void rtcWrite(const clkDateTime &_dt, bool _date_only = false);
+
+  void setUtc(uint32_t _utc, bool _date_only);
+
+  void setDatePart(const clkDateTime &_dt);
+
+  bool waitSecondEdge();
+
+  void prepareUpdate();
+
 public:
   /**
    * @brief конструктор объекта RTC
    *
    */
-  clkSimpleRTC();
+  clkRtc() : cur_time(SECONDS_FROM_1970_TO_2000) {}
+
+  /**
+   * @brief определение подключенной микросхемы в режиме автоопределения (RTC_AUTO_DETECT); при заданном в clockSetting.h модуле только проверяет его наличие
+   *
+   * @return false, если RTC не найден
+   */
+  bool detect();
+
+  /**
+   * @brief тип используемой микросхемы RTC
+   *
+   * @return clkRtcType
+   */
+  clkRtcType getType();
 
   /**
-   * @brief запрос текущих времени и даты из RTC и сохранение их во внутреннем буфере
+   * @brief запрос текущих времени и даты из RTC и сохранение их во внутреннем буфере; при использовании часового пояса (USE_TIME_ZONE) RTC хранит время UTC, а в буфер сохраняется местное время; если RTC не отвечает, в буфер сохраняется программное время
    *
    */
   void now();
 
+  /**
+   * @brief отвечал ли RTC при последнем обращении; если нет, часы идут программно по millis()
+   *
+   * @return true
+   * @return false
+   */
+  bool isOnline();
+
+  /**
+   * @brief количество неудачных обращений к RTC с момента старта или сброса счетчиков
+   *
+   * @return uint16_t
+   */
+  uint16_t getErrorCount();
+
+  /**
+   * @brief сколько раз RTC переставал отвечать с момента старта или сброса счетчиков
+   *
+   * @return uint16_t
+   */
+  uint16_t getOutageCount();
+
+  /**
+   * @brief сброс счетчиков ошибок
+   *
+   */
+  void clearErrorCounters();
+
   /**
    * @brief получение текущего времени и даты из внутреннего буфера
    *
@@ -205,6 +389,55 @@ public:
    */
   clkDateTime getCurTime();
 
+  /**
+   * @brief день недели текущей даты из внутреннего буфера; вычисляется только при смене даты
+   *
+   * @return uint8_t 0 (воскресенье) .. 6 (суббота)
+   */
+  uint8_t getCurDayOfWeek();
+
+  /**
+   * @brief флаги границ времени, пересеченных при последнем вызове now()
+   *
+   * @return uint8_t комбинация значений clkRollover: CLK_NEW_SECOND, CLK_NEW_MINUTE, CLK_NEW_HOUR, CLK_NEW_DAY; новая минута всегда означает и новую секунду и т.д.
+   */
+  uint8_t getRollover();
+
+  /**
+   * @brief количество миллисекунд, прошедших с начала текущей секунды RTC; начало секунды отслеживается по смене секунд при каждом вызове now(), поэтому точность зависит от частоты опроса и уточняется со временем
+   *
+   * @return uint16_t 0..999
+   */
+  uint16_t getCurMillis();
+
+  /**
+   * @brief получение времени UTC последнего опроса RTC; без часового пояса (USE_TIME_ZONE) совпадает с getCurTime().unixtime()
+   *
+   * @return uint32_t секунд с 01.01.1970
+   */
+  uint32_t getCurUtc();
+
+  /**
+   * @brief установка даты и времени целиком по времени UTC
+   *
+   * @param _utc секунд с 01.01.1970
+   */
+  void setCurUtc(uint32_t _utc);
+
+  /**
+   * @brief установка даты и времени целиком; при использовании часового пояса (USE_TIME_ZONE) время считается местным
+   *
+   * @param _dt дата и время для установки
+   */
+  void setCurDateTime(const clkDateTime &_dt);
+
+  /**
+   * @brief включение ожидания начала следующей секунды RTC перед установкой времени, даты или года по отдельности; так остальные поля, прочитанные из RTC, гарантированно не успеют смениться до записи; ожидание занимает до одной секунды
+   *
+   * @param _state true - ждать, false - писать сразу
+   */
+  void setEdgeSync(bool _state);
+
   /**
    * @brief установка текущего времени
    *
@@ -225,20 +458,27 @@ public:
   /**
    * @brief установка текущего года
    *
-   * @param _year год для установки (0..99 )
+   * @param _year год для установки полностью (например, 2024) или двумя цифрами (0..99 - годы 2000..2099); DS3231 и PCF8563 за счет бита века поддерживают годы 2000..2105 (время UTC хранится в uint32_t, предел - 07.02.2106), DS1307 и PCF8523 - 2000..2099
+   */
+  void setCurYear(uint16_t _year);
+
+  /**
+   * @brief счетчик установок времени RTC; увеличивается при каждой записи даты или времени в RTC, по нему можно узнать, что время было переустановлено
+   *
+   * @return uint8_t
    */
-  void setCurYear(uint8_t _year);
+  uint8_t getSetCount();
 
-#if defined(RTC_DS3231)
   /**
-   * @brief возвращает температуру внутреннего датчика DS3231; работает только с DS3231
+   * @brief возвращает температуру внутреннего датчика RTC; датчик есть только у DS3231, для остальных модулей возвращает -127
    *
    * @return int16_t
    */
   int16_t getTemperature();
 
   /**
-   * устанавливает режим 12-часовой (true) или 24-часовой (false).
+   * устанавливает режим 12-часовой (true) или 24-часовой (false); для
+   * модулей без 12-часового режима (PCF8563, PCF8523) ничего не делает.
    * Одна вещь, которая меня беспокоит в том, как я это написал,
    * заключается в том, что если чтение и правка происходят в правильную
    * почасовую миллисекунду, часы будут переведены на час назад.
@@ -248,7 +488,20 @@ public:
    * функция setCurTime() не меняет этот режим.
    */
   void setClockMode(bool h12);
-#endif
+
+  /**
+   * @brief получение значения регистра подстройки частоты: для DS3231 - регистр Aging Offset (шаг около 0.1 ppm, положительное значение замедляет ход), для PCF8523 - регистр Offset (шаг 4.34 ppm, положительное значение ускоряет ход); для модулей без такого регистра возвращает 0
+   *
+   * @return int8_t
+   */
+  int8_t getAgingOffset();
+
+  /**
+   * @brief установка значения регистра подстройки частоты; для модулей без такого регистра ничего не делает
+   *
+   * @param _offset для DS3231 -128..127, для PCF8523 -64..63
+   */
+  void setAgingOffset(int8_t _offset);
 
   /**
    * @brief проверяем, запущен ли генератор
@@ -258,195 +511,532 @@ public:
    */
   bool isRunning();
 
-#if !defined(RTC_DS1307)
   /**
-   * @brief запускаем генератор, в том числе включаем работу от батареи
+   * @brief запускаем генератор, в том числе включаем работу от батареи; для DS1307 ничего не делает - его генератор запускается записью секунд
    *
    */
   void startRTC();
-#endif
 };
 
-// ---- clkSimpleRTC private ---------------------
+// ---- clkRtc private ---------------------------
+
+template <class CHIP>
+void clkRtc<CHIP>::syncSecondEdge(bool _changed)
+{
+  unsigned long t = millis();
+  if (_changed)
+  {
+    // смена секунды произошла между предыдущим и текущим опросами; т.к. секунда
+    // RTC длится ровно 1000 мс, ожидаемый момент смены берется по предыдущей
+    // оценке, и если он попадает в этот интервал, оценка только уточняется
+    unsigned long edge = sec_edge + (t - sec_edge + 500) / 1000 * 1000;
+    if ((long)(edge - t) > 0)
+    {
+      edge = t;
+    }
+    else if ((long)(edge - last_poll) <= 0)
+    {
+      edge = last_poll + 1;
+    }
+    sec_edge = edge;
+  }
+  last_poll = t;
+}
+
+template <class CHIP>
+void clkRtc<CHIP>::updateCalendar(const clkDateTime &_prev, bool _notify)
+{
+  bool new_day = cur_time.day() != _prev.day() ||
+                 cur_time.month() != _prev.month() ||
+                 cur_time.year() != _prev.year();
+  bool new_hour = new_day || cur_time.hour() != _prev.hour();
+  bool new_minute = new_hour || cur_time.minute() != _prev.minute();
+  bool new_second = new_minute || cur_time.second() != _prev.second();
+
+  if (new_day)
+  {
+    cur_dow = cur_time.dayOfTheWeek();
+  }
+  if (_notify)
+  {
+    rollover = (new_second ? CLK_NEW_SECOND : 0) | (new_minute ? CLK_NEW_MINUTE : 0) |
+               (new_hour ? CLK_NEW_HOUR : 0) | (new_day ? CLK_NEW_DAY : 0);
+  }
+}
+
+template <class CHIP>
+void clkRtc<CHIP>::readError()
+{
+  error_count++;
+  if (online)
+  {
+    // RTC перестал отвечать - время продолжает идти от последнего прочитанного значения
+    online = false;
+    outage_count++;
+    soft_utc = cur_utc;
+    soft_start = sec_edge;
+    retry_interval = RTC_RETRY_MIN_INTERVAL;
+  }
+  else
+  {
+    retry_interval = (retry_interval < RTC_RETRY_MAX_INTERVAL / 2) ? retry_interval * 2
+                                                                    : RTC_RETRY_MAX_INTERVAL;
+  }
+  retry_time = millis();
+  softNow();
+}
+
+template <class CHIP>
+void clkRtc<CHIP>::setSoftTime(uint32_t _utc)
+{
+  // запись секунд перезапускает делитель RTC, поэтому новая секунда начинается в момент записи
+  soft_utc = _utc;
+  soft_start = millis();
+  sec_edge = soft_start;
+}
+
+template <class CHIP>
+void clkRtc<CHIP>::softNow()
+{
+  uint32_t s = (millis() - soft_start) / 1000;
+  soft_utc += s;
+  soft_start += s * 1000;
+
+  sec_edge = soft_start;
+  if (cur_utc != soft_utc)
+  {
+    clkDateTime prev(cur_time);
+    cur_utc = soft_utc;
+    updateLocalTime();
+    updateCalendar(prev, true);
+  }
+}
+
+template <class CHIP>
+void clkRtc<CHIP>::updateLocalTime()
+{
+#if defined(USE_TIME_ZONE)
+  cur_time.copyDateTime(clkDateTime(clkTZ.toLocal(cur_utc)));
+#else
+  cur_time.copyDateTime(clkDateTime(cur_utc));
+#endif
+}
+
+template <class CHIP>
+uint8_t clkRtc<CHIP>::decToBcd(uint8_t val) { return ((val / 10 * 16) + (val % 10)); }
 
-uint8_t clkSimpleRTC::decToBcd(uint8_t val) { return ((val / 10 * 16) + (val % 10)); }
-uint8_t clkSimpleRTC::bcdToDec(uint8_t val) { return ((val / 16 * 10) + (val % 16)); }
+template <class CHIP>
+uint8_t clkRtc<CHIP>::bcdToDec(uint8_t val) { return ((val / 16 * 10) + (val % 16)); }
 
-bool clkSimpleRTC::isClockPresent()
+template <class CHIP>
+bool clkRtc<CHIP>::isClockPresent()
 {
-  Wire.beginTransmission(CLOCK_ADDRESS);
+  Wire.beginTransmission(CHIP::address);
   return (Wire.endTransmission() == 0);
 }
 
-uint8_t clkSimpleRTC::read_register(uint8_t reg)
+template <class CHIP>
+uint8_t clkRtc<CHIP>::read_register(uint8_t reg)
 {
-  Wire.beginTransmission(CLOCK_ADDRESS);
+  Wire.beginTransmission(CHIP::address);
   Wire.write(reg);
   Wire.endTransmission();
-  Wire.requestFrom(CLOCK_ADDRESS, 1);
+  Wire.requestFrom(CHIP::address, (uint8_t)1);
   return Wire.read();
 }
 
-void clkSimpleRTC::write_register(uint8_t reg, uint8_t data)
+template <class CHIP>
+void clkRtc<CHIP>::write_register(uint8_t reg, uint8_t data)
 {
-  Wire.beginTransmission(CLOCK_ADDRESS);
+  Wire.beginTransmission(CHIP::address);
   Wire.write(reg);
   Wire.write(data);
   Wire.endTransmission();
 }
 
-// ---- clkSimpleRTC public ----------------------
+template <class CHIP>
+bool clkRtc<CHIP>::read_burst(uint8_t reg, uint8_t *data, uint8_t count)
+{
+  // отсутствие модуля видно уже по ответу на адрес, отдельная проверка наличия не нужна
+  Wire.beginTransmission(CHIP::address);
+  Wire.write(reg);
+  if (Wire.endTransmission() != 0 ||
+      Wire.requestFrom(CHIP::address, count) != count)
+  {
+    return (false);
+  }
+  for (uint8_t i = 0; i < count; i++)
+  {
+    data[i] = Wire.read();
+  }
+  return (true);
+}
 
-clkSimpleRTC::clkSimpleRTC()
+template <class CHIP>
+void clkRtc<CHIP>::write_burst(uint8_t reg, const uint8_t *data, uint8_t count)
 {
-#if !defined(RTC_DS3231) && !defined(RTC_DS1307) && \
-    !defined(RTC_PCF8523) && !defined(RTC_PCF8563)
-#error "Unknown RTC module specified. Set the supported RTC module in clockSetting.h"
-#endif
+  Wire.beginTransmission(CHIP::address);
+  Wire.write(reg);
+  Wire.write(data, count);
+  Wire.endTransmission();
 }
 
-void clkSimpleRTC::now()
+template <class CHIP>
+void clkRtc<CHIP>::rtcWrite(const clkDateTime &_dt, bool _date_only)
 {
-  if (isClockPresent())
+  if (!isClockPresent())
   {
-#if defined(RTC_PCF8563)
-    uint8_t reg = 0x02;
-#elif defined(RTC_PCF8523)
-    uint8_t reg = 0x03;
-#else
-    uint8_t reg = 0x00;
-#endif
+    return;
+  }
 
-    uint8_t b0 = read_register(reg);
-    uint8_t b1 = read_register(++reg);
-    uint8_t b2 = read_register(++reg);
-#if defined(RTC_DS3231) || defined(RTC_DS1307)
-    reg += 2;
-    uint8_t b4 = read_register(reg);
-#else
-    uint8_t b3 = read_register(++reg);
-    reg++;
-#endif
-    uint8_t b5 = read_register(++reg);
-    uint16_t b6 = read_register(++reg);
-
-#if defined(RTC_DS3231)
-    cur_time.copyDateTime(clkDateTime(bcdToDec(b6), bcdToDec(b5 & 0x7F),
-                                     bcdToDec(b4), bcdToDec(b2),
-                                     bcdToDec(b1), bcdToDec(b0 & 0x7F)));
-#elif defined(RTC_DS1307)
-    cur_time.copyDateTime(clkDateTime(bcdToDec(b6), bcdToDec(b5),
-                                     bcdToDec(b4), bcdToDec(b2),
-                                     bcdToDec(b1), bcdToDec(b0 & 0x7F)));
-#elif defined(RTC_PCF8563)
-    cur_time.copyDateTime(clkDateTime(bcdToDec(b6), bcdToDec(b5 & 0x1F),
-                                     bcdToDec(b3 & 0x3f), bcdToDec(b2 & 0x3f),
-                                     bcdToDec(b1 & 0x7f), bcdToDec(b0 & 0x7F)));
-#elif defined(RTC_PCF8523)
-    cur_time.copyDateTime(clkDateTime(bcdToDec(b6), bcdToDec(b5),
-                                     bcdToDec(b3), bcdToDec(b2),
-                                     bcdToDec(b1), bcdToDec(b0 & 0x7F)));
-#else
-    cur_time.copyDateTime(clkDateTime(0, 1, 1, 0, 0, 0));
-#endif
+  // весь блок времени и даты пишется одной транзакцией: модуль защелкивает
+  // его целиком, и переноса секунд между записью отдельных регистров не бывает
+  uint8_t buf[CLOCK_TIME_REGISTER_COUNT];
+  uint16_t year = (_dt.year() < 2000) ? 2000 : _dt.year();
+  buf[0] = decToBcd(_dt.second());
+  buf[1] = decToBcd(_dt.minute());
+  // устанавливаем час с учетом бита 12/24 часа
+  if (CHIP::hour12_mask && (read_register(CHIP::time_reg + 2) & CHIP::hour12_mask))
+  {
+    // 12 hour: 1..12 и бит PM
+    uint8_t h = _dt.hour() % 12;
+    buf[2] = decToBcd((h == 0) ? 12 : h) | CHIP::hour12_mask | ((_dt.hour() >= 12) ? 0b00100000 : 0);
   }
   else
   {
-    cur_time.copyDateTime(clkDateTime(0, 1, 1, 0, 0, 0));
+    buf[2] = decToBcd(_dt.hour());
   }
-}
+  buf[CHIP::day_offset] = decToBcd(_dt.day());
+  buf[CHIP::dow_offset] = _dt.dayOfTheWeek() + CHIP::dow_base;
+  buf[5] = decToBcd(_dt.month());
+  // бит века - старший бит регистра месяца: 0 - годы 2000..2099, 1 - 2100..2199
+  if (year >= 2100)
+  {
+    buf[5] |= CHIP::century_mask;
+  }
+  buf[6] = decToBcd(year % 100);
+  if (_date_only)
+  {
+    // запись регистра секунд перезапускает делитель RTC и сдвигает время на
+    // долю секунды, поэтому при смене даты пишутся только регистры даты (3..6
+    // у всех поддерживаемых модулей)
+    write_burst(CHIP::time_reg + 3, buf + 3, CLOCK_TIME_REGISTER_COUNT - 3);
+    return;
+  }
+  write_burst(CHIP::time_reg, buf, CLOCK_TIME_REGISTER_COUNT);
 
-clkDateTime clkSimpleRTC::getCurTime() { return (cur_time); }
+  if (CHIP::stop_reg != CHIP::time_reg)
+  {
+    // флаг остановки генератора в отдельном регистре (OSF у DS3231) записью
+    // секунд не сбрасывается - очищаем его
+    write_register(CHIP::stop_reg, read_register(CHIP::stop_reg) & 0x7F);
+  }
+  if (CHIP::type == CLK_RTC_PCF8523)
+  {
+    // устанавливаем режим работы от батареи
+    write_register(0x02, 0x00);
+  }
+}
 
-void clkSimpleRTC::setCurTime(uint8_t _hour, uint8_t _minute, uint8_t _second)
+template <class CHIP>
+bool clkRtc<CHIP>::waitSecondEdge()
 {
-  if (isClockPresent())
+  if (!isClockPresent())
   {
-#if defined(RTC_PCF8563)
-    uint8_t reg = 0x02;
-#elif defined(RTC_PCF8523)
-    uint8_t reg = 0x03;
-#else
-    uint8_t reg = 0x00;
-#endif
-    write_register(reg, decToBcd(_second));
-    write_register(++reg, decToBcd(_minute));
-#if defined(RTC_DS3231)
-    // устанавливаем час с учетом бита 12/24 часа
-    bool h12 = (read_register(++reg) & 0b01000000);
-    if (h12)
+    return (false);
+  }
+
+  uint8_t sec = read_register(CHIP::time_reg) & 0x7F;
+  uint32_t tmr = millis();
+  while (millis() - tmr < 1100)
+  {
+    if ((read_register(CHIP::time_reg) & 0x7F) != sec)
     {
-      // 12 hour
-      if (_hour > 12)
-      {
-        _hour = decToBcd(_hour - 12) | 0b01100000;
-      }
-      else
-      {
-        _hour = decToBcd(_hour) & 0b11011111;
-      }
+      return (true);
     }
-    else
+  }
+  return (false);
+}
+
+template <class CHIP>
+void clkRtc<CHIP>::prepareUpdate()
+{
+  // если меняется только часть даты/времени, остальное берется из RTC; сразу
+  // после смены секунды до следующего переноса остается почти целая секунда
+  if (edge_sync)
+  {
+    waitSecondEdge();
+  }
+  now();
+}
+
+// ---- clkRtc public ----------------------------
+
+template <class CHIP>
+bool clkRtc<CHIP>::detect()
+{
+  return (CHIP::detect() && isClockPresent());
+}
+
+template <class CHIP>
+clkRtcType clkRtc<CHIP>::getType() { return (CHIP::type); }
+
+template <class CHIP>
+void clkRtc<CHIP>::now()
+{
+  rollover = 0;
+  if (!online && millis() - retry_time < retry_interval)
+  {
+    // время следующей попытки связи с RTC еще не пришло
+    softNow();
+    return;
+  }
+
+  // при каждом опросе читается только регистр секунд; секунды больше 59 бывают только при сбое на шине
+  uint8_t sec;
+  if (!read_burst(CHIP::time_reg, &sec, 1) || (sec & 0x7F) > 0x59)
+  {
+    readError();
+    return;
+  }
+  sec = bcdToDec(sec & 0x7F);
+
+  if (!online)
+  {
+    online = true;
+    retry_interval = 0;
+    synced = false;
+    if (!isRunning())
     {
-      // 24 hour
-      _hour = decToBcd(_hour) & 0b10111111;
+      // модуль потерял питание, пока не отвечал, - переносим в него программное время
+      softNow();
+      setCurUtc(cur_utc);
+      startRTC();
+      return;
     }
-    write_register(reg, _hour);
-#else
-    write_register(++reg, decToBcd(_hour));
-#endif
-#if defined(RTC_DS3231)
-    // Очищаем флаг OSF
-    uint8_t temp_buffer = read_register(0x0f);
-    write_register(0x0f, (temp_buffer & 0x7F));
-#elif defined(RTC_PCF8523)
-    // устанавливаем режим работы от батареи
-    write_register(0x02, 0x00);
-#endif
   }
+
+  // RTC хранит секунды UTC; без часового пояса они совпадают с секундами cur_time
+  uint8_t prev_second = cur_utc % 60;
+  if (synced && sec == prev_second)
+  {
+    syncSecondEdge(false);
+    return;
+  }
+  if (synced && sec == prev_second + 1 && cur_time.second() < 59)
+  {
+    // секунда сменилась внутри минуты - календарь сдвигается на секунду без чтения остальных регистров
+    cur_utc++;
+    cur_time.copyDateTime(clkDateTime(cur_time.year(), cur_time.month(), cur_time.day(),
+                                      cur_time.hour(), cur_time.minute(), cur_time.second() + 1));
+    rollover = CLK_NEW_SECOND;
+    syncSecondEdge(true);
+    return;
+  }
+
+  // сменилась минута или время изменилось скачком - блок времени и даты читается целиком одной транзакцией
+  uint8_t buf[CLOCK_TIME_REGISTER_COUNT];
+  if (!read_burst(CHIP::time_reg, buf, CLOCK_TIME_REGISTER_COUNT) || (buf[0] & 0x7F) > 0x59)
+  {
+    readError();
+    return;
+  }
+
+  uint16_t year = 2000 + bcdToDec(buf[6]);
+  // бит века в регистре месяца
+  if (buf[5] & CHIP::century_mask)
+  {
+    year += 100;
+  }
+
+  uint8_t hour;
+  if (buf[2] & CHIP::hour12_mask)
+  {
+    // 12-часовой режим: 1..12 и бит PM
+    hour = bcdToDec(buf[2] & 0x1F) % 12 + ((buf[2] & 0b00100000) ? 12 : 0);
+  }
+  else
+  {
+    hour = bcdToDec(buf[2] & 0x3F);
+  }
+
+  uint8_t month = bcdToDec(buf[5] & 0x1F);
+  uint8_t day = bcdToDec(buf[CHIP::day_offset] & 0x3F);
+  // DS3231 и PCF8563 считают високосным каждый четвертый год, в т.ч. 2100;
+  // несуществующее 29 февраля такого года исправляется на 1 марта - и в RTC
+  bool leap_fix = (month == 2 && day == 29 && !isLeapYear(year));
+  if (leap_fix)
+  {
+    month = 3;
+    day = 1;
+  }
+
+  clkDateTime prev(cur_time);
+  cur_time.copyDateTime(clkDateTime(year, month, day, hour,
+                                    bcdToDec(buf[1] & 0x7F), bcdToDec(buf[0] & 0x7F)));
+  cur_utc = cur_time.unixtime();
+  if (leap_fix)
+  {
+    rtcWrite(cur_time, true);
+  }
+#if defined(USE_TIME_ZONE)
+  // RTC хранит время UTC
+  cur_time.copyDateTime(clkDateTime(clkTZ.toLocal(cur_utc)));
+#endif
+  // после старта или восстановления связи прежнее значение недостоверно - событий нет
+  updateCalendar(prev, synced);
+  synced = true;
+  syncSecondEdge(cur_utc % 60 != prev_second);
 }
 
-void clkSimpleRTC::setCurDate(uint8_t _date, uint8_t _month)
+template <class CHIP>
+bool clkRtc<CHIP>::isOnline() { return (online); }
+
+template <class CHIP>
+uint16_t clkRtc<CHIP>::getErrorCount() { return (error_count); }
+
+template <class CHIP>
+uint16_t clkRtc<CHIP>::getOutageCount() { return (outage_count); }
+
+template <class CHIP>
+void clkRtc<CHIP>::clearErrorCounters()
 {
-  if (isClockPresent())
+  error_count = 0;
+  outage_count = 0;
+}
+
+template <class CHIP>
+clkDateTime clkRtc<CHIP>::getCurTime() { return (cur_time); }
+
+template <class CHIP>
+uint8_t clkRtc<CHIP>::getCurDayOfWeek() { return (cur_dow); }
+
+template <class CHIP>
+uint8_t clkRtc<CHIP>::getRollover() { return (rollover); }
+
+template <class CHIP>
+uint16_t clkRtc<CHIP>::getCurMillis()
+{
+  unsigned long x = millis() - sec_edge;
+  return ((x > 999) ? 999 : x);
+}
+
+template <class CHIP>
+uint32_t clkRtc<CHIP>::getCurUtc() { return (cur_utc); }
+
+template <class CHIP>
+void clkRtc<CHIP>::setUtc(uint32_t _utc, bool _date_only)
+{
+  clkDateTime utc = clkDateTime(_utc);
+  rtcWrite(utc, _date_only);
+  set_count++;
+  if (_date_only)
   {
-#if defined(RTC_PCF8563)
-    write_register(0x05, decToBcd(_date));
-    write_register(0x07, decToBcd(_month));
-#elif defined(RTC_PCF8523)
-    write_register(0x06, decToBcd(_date));
-    write_register(0x08, decToBcd(_month));
+    // секунда RTC не перезапускалась - программное время сдвигается на ту же величину
+    soft_utc += _utc - cur_utc;
+  }
+  else
+  {
+    setSoftTime(_utc);
+  }
+
+  cur_utc = _utc;
+#if defined(USE_TIME_ZONE)
+  cur_time.copyDateTime(clkDateTime(clkTZ.toLocal(_utc)));
 #else
-    write_register(0x04, decToBcd(_date));
-    write_register(0x05, decToBcd(_month));
+  cur_time.copyDateTime(utc);
 #endif
-  }
+  cur_dow = cur_time.dayOfTheWeek();
+  synced = true;
 }
 
-void clkSimpleRTC::setCurYear(uint8_t _year)
+template <class CHIP>
+void clkRtc<CHIP>::setDatePart(const clkDateTime &_dt)
 {
-  if (isClockPresent())
-  {
-#if defined(RTC_PCF8563)
-    write_register(0x08, decToBcd(_year % 100));
-#elif defined(RTC_PCF8523)
-    write_register(0x09, decToBcd(_year % 100));
+#if defined(USE_TIME_ZONE)
+  uint32_t utc = clkTZ.toUtc(_dt.unixtime());
 #else
-    write_register(0x06, decToBcd(_year % 100));
+  uint32_t utc = _dt.unixtime();
 #endif
+  if (utc % 86400ul == cur_utc % 86400ul)
+  {
+    setUtc(utc, true);
+    return;
   }
+
+  // на новую дату приходится другое смещение часового пояса (летнее время),
+  // и меняется время UTC - блок времени пишется целиком, но сразу после смены
+  // секунды, чтобы перезапуск делителя RTC не сдвинул время
+  uint32_t prev = cur_utc;
+  if (!edge_sync && waitSecondEdge())
+  {
+    now();
+    utc += cur_utc - prev;
+  }
+  setUtc(utc, false);
+}
+
+template <class CHIP>
+void clkRtc<CHIP>::setCurUtc(uint32_t _utc) { setUtc(_utc, false); }
+
+template <class CHIP>
+void clkRtc<CHIP>::setCurDateTime(const clkDateTime &_dt)
+{
+#if defined(USE_TIME_ZONE)
+  // местное время пересчитывается в UTC и записывается в RTC целиком, т.к.
+  // смена часа может сдвинуть и дату UTC
+  setCurUtc(clkTZ.toUtc(_dt.unixtime()));
+#else
+  rtcWrite(_dt);
+  set_count++;
+  cur_time.copyDateTime(_dt);
+  cur_utc = _dt.unixtime();
+  setSoftTime(cur_utc);
+  cur_dow = cur_time.dayOfTheWeek();
+  synced = true;
+#endif
+}
+
+template <class CHIP>
+void clkRtc<CHIP>::setEdgeSync(bool _state) { edge_sync = _state; }
+
+template <class CHIP>
+void clkRtc<CHIP>::setCurTime(uint8_t _hour, uint8_t _minute, uint8_t _second)
+{
+  prepareUpdate();
+  setCurDateTime(clkDateTime(cur_time.year(), cur_time.month(), cur_time.day(),
+                             _hour, _minute, _second));
+}
+
+template <class CHIP>
+void clkRtc<CHIP>::setCurDate(uint8_t _date, uint8_t _month)
+{
+  prepareUpdate();
+  setDatePart(clkDateTime(cur_time.year(), _month, _date,
+                          cur_time.hour(), cur_time.minute(), cur_time.second()));
+}
+
+template <class CHIP>
+void clkRtc<CHIP>::setCurYear(uint16_t _year)
+{
+  prepareUpdate();
+  setDatePart(clkDateTime(_year, cur_time.month(), cur_time.day(),
+                          cur_time.hour(), cur_time.minute(), cur_time.second()));
 }
 
-#if defined(RTC_DS3231)
-int16_t clkSimpleRTC::getTemperature()
+template <class CHIP>
+uint8_t clkRtc<CHIP>::getSetCount() { return (set_count); }
+
+template <class CHIP>
+int16_t clkRtc<CHIP>::getTemperature()
 {
   uint8_t tMSB, tLSB;
   int16_t temp3231 = -127;
 
-  if (isClockPresent())
+  if (CHIP::temp_reg && isClockPresent())
   { // временные регистры (11h-12h) обновляются автоматически каждые 64 секунды.
-    tMSB = read_register(0x11);
-    tLSB = read_register(0x12);
+    tMSB = read_register(CHIP::temp_reg);
+    tLSB = read_register(CHIP::temp_reg + 1);
 
     uint16_t x = ((((short)tMSB << 8) | (short)tLSB) >> 6);
     temp3231 = (x % 4 > 2) ? x / 4 + 1 : x / 4;
@@ -455,77 +1045,128 @@ int16_t clkSimpleRTC::getTemperature()
   return (temp3231);
 }
 
-void clkSimpleRTC::setClockMode(bool h12)
+template <class CHIP>
+void clkRtc<CHIP>::setClockMode(bool h12)
 {
-  if (isClockPresent())
+  if (CHIP::hour12_mask && isClockPresent())
   {
     uint8_t temp_buffer;
 
-    // считывание байта 0x02.
-    temp_buffer = read_register(0x02);
+    // считывание регистра часов
+    temp_buffer = read_register(CHIP::time_reg + 2);
 
     // установка заданного флага:
     if (h12)
     {
-      temp_buffer = temp_buffer | 0b01000000;
+      temp_buffer = temp_buffer | CHIP::hour12_mask;
     }
     else
     {
-      temp_buffer = temp_buffer & 0b10111111;
+      temp_buffer = temp_buffer & ~CHIP::hour12_mask;
     }
 
     // запись байта
-    write_register(0x02, temp_buffer);
+    write_register(CHIP::time_reg + 2, temp_buffer);
+  }
+}
+
+template <class CHIP>
+int8_t clkRtc<CHIP>::getAgingOffset()
+{
+  int8_t result = 0;
+  if (CHIP::aging_reg && isClockPresent())
+  {
+    if (CHIP::type == CLK_RTC_PCF8523)
+    {
+      // младшие 7 бит - знаковое значение, старший бит - режим коррекции (0 - раз в два часа)
+      result = (int8_t)(read_register(CHIP::aging_reg) << 1) >> 1;
+    }
+    else
+    {
+      result = (int8_t)read_register(CHIP::aging_reg);
+    }
+  }
+  return (result);
+}
+
+template <class CHIP>
+void clkRtc<CHIP>::setAgingOffset(int8_t _offset)
+{
+  if (CHIP::aging_reg && isClockPresent())
+  {
+    if (CHIP::type == CLK_RTC_PCF8523)
+    {
+      if (_offset < -64)
+      {
+        _offset = -64;
+      }
+      else if (_offset > 63)
+      {
+        _offset = 63;
+      }
+      write_register(CHIP::aging_reg, (uint8_t)_offset & 0x7F);
+    }
+    else
+    {
+      write_register(CHIP::aging_reg, (uint8_t)_offset);
+      // новое значение вступает в силу после очередного измерения температуры - запускаем его сразу
+      write_register(0x0E, read_register(0x0E) | 0b00100000);
+    }
   }
 }
-#endif
 
-bool clkSimpleRTC::isRunning()
+template <class CHIP>
+bool clkRtc<CHIP>::isRunning()
 {
   bool result = false;
 
   if (isClockPresent())
   {
-#if defined(RTC_DS1307)
-    result = !(read_register(0x00) >> 7);
-#elif defined(RTC_DS3231)
-    result = !(read_register(0x0f) >> 7);
-#elif defined(RTC_PCF8563)
-    result = !(read_register(0x02) >> 7);
-#elif defined(RTC_PCF8523)
-    result = !(read_register(0x03) >> 7);
-#endif
+    result = !(read_register(CHIP::stop_reg) >> 7);
 
-#if defined(RTC_PCF8523)
-    result = result && ((read_register(0x02) & 0xE0) != 0xE0);
-#endif
+    if (CHIP::type == CLK_RTC_PCF8523)
+    {
+      result = result && ((read_register(0x02) & 0xE0) != 0xE0);
+    }
   }
 
   return result;
 }
 
-#if !defined(RTC_DS1307)
-void clkSimpleRTC::startRTC()
+template <class CHIP>
+void clkRtc<CHIP>::startRTC()
 {
-#if defined(RTC_DS3231)
-  uint8_t temp_buffer = read_register(0x0e) & 0b11100111;
-  // поднимаем флаг BBSQW - работа от батареи
-  temp_buffer = temp_buffer | 0b01000000;
-  // устанавливаем ~EOSC и INTCN в 0 - запускаем генератор
-  temp_buffer = temp_buffer & 0b01111011;
-  // записываем контрольный бит
-  write_register(0x0e, temp_buffer);
-#else
-  uint8_t ctlreg = read_register(0x00);
-  // Проверяем STOP бит и сбрасываем его
-  if (ctlreg & (1 << 5))
+  switch (CHIP::type)
+  {
+  case CLK_RTC_DS3231:
   {
-    write_register(0x00, (ctlreg & ~(1 << 5)));
+    uint8_t temp_buffer = read_register(0x0e) & 0b11100111;
+    // поднимаем флаг BBSQW - работа от батареи
+    temp_buffer = temp_buffer | 0b01000000;
+    // устанавливаем ~EOSC и INTCN в 0 - запускаем генератор
+    temp_buffer = temp_buffer & 0b01111011;
+    // записываем контрольный бит
+    write_register(0x0e, temp_buffer);
+  }
+  break;
+  case CLK_RTC_PCF8563:
+  case CLK_RTC_PCF8523:
+  {
+    uint8_t ctlreg = read_register(0x00);
+    // Проверяем STOP бит и сбрасываем его
+    if (ctlreg & (1 << 5))
+    {
+      write_register(0x00, (ctlreg & ~(1 << 5)));
+    }
+  }
+  break;
+  default:
+    break;
   }
-#endif
 }
-#endif
 
-// ==== end clkSimpleRTC ==============================
+// ==== end clkRtc ===================================
+
+typedef clkRtc<clkRtcChip> clkSimpleRTC;
 
 clkSimpleRTC clkClock;
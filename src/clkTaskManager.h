@@ -5,45 +5,190 @@
  * @brief диспетчер задач;
  *        полная версия здесь - https://github.com/VAleSh-Soft/shTaskManager
  *
- * @version 1.6
- * @date 17.05.2026
+ * @version 1.8
+ * @date 19.10.2026
  *
  * @copyright Copyright (c) 2024
  *
  */
 #pragma once
+#if __USE_WATCHDOG__
+#include "clkWatchdog.h"
+#endif
+#if defined(USE_TASK_TRACE)
+#include "clkTaskTrace.h"
+#endif
 
 // ==== clkTaskManager ===============================
 
-typedef void (*clkTaskManagerCallback)(void); // тип - указатель для Callback-функции
-typedef int8_t clkHandle;                     // тип - идентификатор задачи
+typedef void (*clkTaskManagerCallback)(void);     // тип - указатель для Callback-функции
+typedef void (*clkTaskCallback)(void *_context); // тип - указатель для Callback-функции с контекстом
+typedef int8_t clkHandle;                        // тип - идентификатор задачи
 static const clkHandle CLK_INVALID_HANDLE = -1;
 
+/*
+ * функция задачи получает указатель на контекст - данные, с которыми она
+ * работает (состояние, объект и т.п.); это позволяет нескольким задачам
+ * использовать одну функцию с разными данными, не заводя для каждой свои
+ * статические переменные; контекст хранится в самой задаче, память под него
+ * не выделяется;
+ *
+ * функция без параметров (clkTaskManagerCallback) хранится в поле контекста
+ * и вызывается через clk_plain_task(); для вызова метода объекта служит
+ * шаблон clkTaskMethod<Класс, &Класс::метод>, объект передается как контекст
+ */
+
+/*
+ * если задача не смогла сработать вовремя (например, из-за долгого опроса
+ * датчика или вывода на экран) и пропустила один или несколько периодов,
+ * дальнейшее поведение определяется политикой задачи:
+ *   CLK_OVERRUN_CATCH_UP - пропущенные срабатывания выполняются подряд при
+ *                          следующих вызовах tick(), пока задача не догонит
+ *                          свое расписание (поведение по умолчанию);
+ *   CLK_OVERRUN_SKIP     - пропущенные срабатывания отбрасываются, задача
+ *                          срабатывает один раз и продолжает в прежней фазе;
+ *   CLK_OVERRUN_REPHASE  - задача срабатывает один раз, и следующий период
+ *                          отсчитывается от текущего момента;
+ * в любом случае для задачи подсчитывается количество таких опозданий
+ */
+
+enum clkOverrunPolicy : uint8_t
+{
+  CLK_OVERRUN_CATCH_UP,
+  CLK_OVERRUN_SKIP,
+  CLK_OVERRUN_REPHASE
+};
+
 struct clkTask // структура, описывающая задачу
 {
-  bool status;                     // статус задачи
-  unsigned long timer;             // таймер задачи
-  unsigned long interval;          // интервал срабатывания задачи
-  clkTaskManagerCallback callback; // функция, вызываемая при срабатывании таймера задачи
+  bool status;              // статус задачи
+  clkOverrunPolicy policy;  // поведение при пропуске периодов
+  bool behind;              // задача отстала и наверстывает пропущенные периоды
+  uint16_t overruns;        // количество опозданий на период и более
+  unsigned long timer;      // таймер задачи
+  unsigned long interval;   // интервал срабатывания задачи
+  clkTaskCallback callback; // функция, вызываемая при срабатывании таймера задачи
+  void *context;            // данные, передаваемые функции задачи
 };
 
+void clk_plain_task(void *_context)
+{
+  reinterpret_cast<clkTaskManagerCallback>(_context)();
+}
+
+template <class T, void (T::*METHOD)()>
+void clkTaskMethod(void *_context)
+{
+  (static_cast<T *>(_context)->*METHOD)();
+}
+
+// ---- количество задач -----------------------
+
+/*
+ * размер списка задач определяется на этапе компиляции: встроенные задачи
+ * считаются по включенным опциям, к ним добавляется ADDITIONAL_TASK_COUNT
+ * пользовательских задач (задается в clockSetting.h); список размещается в
+ * статической памяти, поэтому объем занимаемой им RAM виден в отчете
+ * компоновщика и доступен через clkTaskManager<N>::memory_size;
+ *
+ * свободные ячейки списка связаны в односвязный список (next_free), поэтому
+ * добавление и удаление задачи выполняются за постоянное время
+ */
+
+#if !defined(ADDITIONAL_TASK_COUNT)
+#define ADDITIONAL_TASK_COUNT 0
+#endif
+
+static constexpr uint8_t CLK_BUILTIN_TASK_COUNT = 5 // базовое количество задач
+#if defined(USE_ALARM)
+                                                  + 2
+#endif
+#if __USE_AUTO_SHOW_DATA__
+                                                  + 1
+#endif
+#if __USE_TEMP_DATA__ && defined(USE_DS18B20)
+                                                  + 1
+#endif
+#if __USE_LIGHT_SENSOR__
+                                                  + 1
+#endif
+#if __USE_OTHER_SETTING__
+                                                  + 1
+#endif
+#if defined(USE_TICKER_FOR_DATA)
+                                                  + 1
+#endif
+#if defined(USE_DIGIT_ANIMATION)
+                                                  + 1
+#endif
+#if __USE_EEPROM_WRITE_BEHIND__
+                                                  + 1
+#endif
+    ;
+
+static constexpr uint8_t CLK_TASK_COUNT = CLK_BUILTIN_TASK_COUNT + ADDITIONAL_TASK_COUNT;
+
+#if __USE_WATCHDOG__
+/*
+ * контроль задач: для задачи задается срок, в течение которого она должна
+ * отметиться - сработать или вызвать heartbeat(); пока все активные
+ * контролируемые задачи укладываются в свои сроки, tick() сбрасывает
+ * аппаратный сторожевой таймер; остановленные задачи не контролируются;
+ *
+ * перед вызовом функции задачи ее номер записывается в clk_wdt_record,
+ * поэтому при перезагрузке из-за зависания внутри задачи известно, какая
+ * задача зависла; если же задача перестала срабатывать, записывается номер
+ * задачи, пропустившей срок
+ */
+
+#if !defined(WATCHDOG_TASK_COUNT)
+#define WATCHDOG_TASK_COUNT 4 // максимальное количество контролируемых задач
+#endif
+
+struct clkTaskWatch
+{
+  clkHandle handle;    // контролируемая задача
+  uint16_t deadline;   // срок, мс
+  unsigned long beat;  // время последней отметки
+};
+#endif
+
+template <uint8_t N>
 class clkTaskManager
 {
 private:
-  uint8_t task_count = 0;
-  uint8_t add_task_count = 0;
-  clkTask *taskList = nullptr;
+  // идентификатор задачи - int8_t, отрицательные значения заняты под CLK_INVALID_HANDLE
+  static_assert(N > 0 && N <= 127, "the task list size must be in the range 1..127");
+
+  clkTask taskList[N];
+  clkHandle next_free[N];  // следующая свободная ячейка для каждой свободной ячейки
+  clkHandle free_head = 0; // первая свободная ячейка; CLK_INVALID_HANDLE - свободных нет
+  uint8_t free_count = N;
 
   bool isValidHandle(clkHandle _handle);
 
+  void updateTimer(clkTask &_task, unsigned long _elapsed);
+
+#if __USE_WATCHDOG__
+  clkTaskWatch watch[WATCHDOG_TASK_COUNT];
+  uint8_t watch_count = 0;
+  bool wdt_started = false;
+  clkHandle last_failed = CLK_INVALID_HANDLE; // задача, приведшая к предыдущей перезагрузке
+
+  void supervise();
+#endif
+
 public:
+  static constexpr uint8_t capacity = N;                                     // размер списка задач
+  static constexpr size_t memory_size = sizeof(taskList) + sizeof(next_free); // объем RAM под список задач, байт
+
   clkHandle rtc_guard;              // опрос микросхемы RTC по таймеру, чтобы не дергать ее откуда попало
   clkHandle blink_timer;            // блинк
   clkHandle return_to_default_mode; // таймер автовозврата в режим показа времени из любого режима настройки
   clkHandle set_time_mode;          // режим настройки времени
   clkHandle display_guard;          // вывод данных на экран
 #if defined(USE_ALARM)
-  clkHandle alarm_guard;  // отслеживание состояния будильника
+  clkHandle alarm_guard;  // светодиод будильника
   clkHandle alarm_buzzer; // пищалка будильника
 #endif
 #if __USE_AUTO_SHOW_DATA__
@@ -61,15 +206,23 @@ public:
 #if defined(USE_TICKER_FOR_DATA)
   clkHandle ticker; // отработка бегущей строки
 #endif
+#if defined(USE_DIGIT_ANIMATION)
+  clkHandle digit_animation; // анимация смены цифр времени
+#endif
+#if __USE_EEPROM_WRITE_BEHIND__
+  clkHandle eeprom_guard; // отложенная запись настроек во флеш
+#endif
 
   clkTaskManager();
 
-  void init(uint8_t _taskCount);
-
   void tick();
 
   clkHandle addTask(unsigned long _interval, clkTaskManagerCallback _callback, bool isActive = true);
 
+  clkHandle addTask(unsigned long _interval, clkTaskCallback _callback, void *_context, bool isActive = true);
+
+  void delTask(clkHandle _handle);
+
   void startTask(clkHandle _handle);
 
   void stopTask(clkHandle _handle);
@@ -80,62 +233,225 @@ public:
 
   void taskExes(clkHandle _handle, bool _restart = true);
 
-  void setAddTaskCount(uint8_t _add_count);
+  void setOverrunPolicy(clkHandle _handle, clkOverrunPolicy _policy);
+
+  uint16_t getOverrunCount(clkHandle _handle);
+
+  void clearOverrunCount(clkHandle _handle);
+
+  uint8_t getCapacity();
+
+  uint8_t getFreeCount();
+
+#if __USE_WATCHDOG__
+  /**
+   * @brief включение контроля задачи; аппаратный сторожевой таймер запускается при первом вызове tick()
+   *
+   * @param _handle идентификатор задачи
+   * @param _deadline срок, в течение которого задача должна отметиться, мс; 0 - отключить контроль
+   * @return false, если все WATCHDOG_TASK_COUNT мест заняты
+   */
+  bool superviseTask(clkHandle _handle, uint16_t _deadline);
+
+  /**
+   * @brief отметка задачи; нужна, если задача долго работает внутри одного вызова
+   *
+   * @param _handle идентификатор задачи
+   */
+  void heartbeat(clkHandle _handle);
+
+  /**
+   * @brief задача, из-за которой произошла предыдущая перезагрузка по сторожевому таймеру
+   *
+   * @return clkHandle CLK_INVALID_HANDLE, если такой задачи не было
+   */
+  clkHandle getLastFailedTask();
+#endif
 };
 
 // ---- clkTaskManager private ------------------
 
-bool clkTaskManager::isValidHandle(clkHandle _handle)
+template <uint8_t N>
+bool clkTaskManager<N>::isValidHandle(clkHandle _handle)
 {
-  return (_handle > CLK_INVALID_HANDLE && _handle < (task_count + add_task_count));
+  return (_handle > CLK_INVALID_HANDLE && _handle < N);
 }
-// ---- clkTaskManager public -------------------
-
-clkTaskManager::clkTaskManager() {}
 
-void clkTaskManager::init(uint8_t _taskCount)
+template <uint8_t N>
+void clkTaskManager<N>::updateTimer(clkTask &_task, unsigned long _elapsed)
 {
-  task_count = (_taskCount) ? _taskCount : 1;
-  taskList = (clkTask *)calloc((task_count + add_task_count), sizeof(clkTask));
-  if (taskList == nullptr)
+  if (_elapsed < _task.interval * 2 || _task.interval == 0)
+  {
+    // срабатывание вовремя
+    _task.timer += _task.interval;
+    _task.behind = false;
+    return;
+  }
+
+  // при наверстывании одна задержка считается одним опозданием, а не
+  // числом повторенных периодов
+  if (!_task.behind && _task.overruns < 0xFFFF)
+  {
+    _task.overruns++;
+  }
+  _task.behind = (_task.policy == CLK_OVERRUN_CATCH_UP);
+  switch (_task.policy)
   {
-    task_count = 0;
-    add_task_count = 0;
+  case CLK_OVERRUN_SKIP:
+    _task.timer += _elapsed - _elapsed % _task.interval;
+    break;
+  case CLK_OVERRUN_REPHASE:
+    _task.timer += _elapsed;
+    break;
+  default:
+    _task.timer += _task.interval;
+    break;
   }
 }
 
-void clkTaskManager::tick()
+#if __USE_WATCHDOG__
+template <uint8_t N>
+void clkTaskManager<N>::supervise()
 {
-  for (uint8_t i = 0; i < (task_count + add_task_count); i++)
+  if (!wdt_started)
   {
-    if (taskList[i].status && taskList[i].callback != nullptr)
+    clk_wdt_begin();
+    wdt_started = true;
+  }
+
+  for (uint8_t i = 0; i < watch_count; i++)
+  {
+    if (!getTaskState(watch[i].handle))
+    {
+      // остановленная задача не отмечается; срок отсчитывается заново после ее запуска
+      watch[i].beat = millis();
+    }
+    else if (millis() - watch[i].beat > watch[i].deadline)
     {
-      if (millis() - taskList[i].timer >= taskList[i].interval)
+      // таймер больше не сбрасывается; если задача не отметится, пока он не истек, будет перезагрузка
+      if (clk_wdt_record.failed != watch[i].handle)
       {
-        taskList[i].timer += taskList[i].interval;
-        taskList[i].callback();
+        clk_wdt_record.set(CLK_INVALID_HANDLE, watch[i].handle);
       }
+      return;
     }
   }
+
+  if (clk_wdt_record.failed != CLK_INVALID_HANDLE)
+  {
+    // задача успела отметиться - сбой не состоялся
+    clk_wdt_record.set(CLK_INVALID_HANDLE, CLK_INVALID_HANDLE);
+  }
+  clk_wdt_feed();
 }
+#endif
 
-clkHandle clkTaskManager::addTask(unsigned long _interval, clkTaskManagerCallback _callback, bool isActive)
+// ---- clkTaskManager public -------------------
+
+template <uint8_t N>
+clkTaskManager<N>::clkTaskManager()
 {
-  for (uint8_t i = 0; i < (task_count + add_task_count); i++)
+  for (uint8_t i = 0; i < N; i++)
+  {
+    taskList[i].status = false;
+    taskList[i].callback = nullptr;
+    taskList[i].context = nullptr;
+    next_free[i] = (i + 1 < N) ? i + 1 : CLK_INVALID_HANDLE;
+  }
+#if __USE_WATCHDOG__
+  // запись читается до первого срабатывания задач, которые ее перезапишут
+  if (clk_wdt_caused_reset() && clk_wdt_record.isValid())
   {
-    if (!taskList[i].callback)
+    last_failed = (clk_wdt_record.running != CLK_INVALID_HANDLE) ? clk_wdt_record.running
+                                                                  : clk_wdt_record.failed;
+  }
+  clk_wdt_record.set(CLK_INVALID_HANDLE, CLK_INVALID_HANDLE);
+#endif
+}
+
+template <uint8_t N>
+void clkTaskManager<N>::tick()
+{
+  for (uint8_t i = 0; i < N; i++)
+  {
+    if (taskList[i].status && taskList[i].callback != nullptr)
     {
-      taskList[i].status = isActive;
-      taskList[i].interval = _interval;
-      taskList[i].callback = _callback;
-      taskList[i].timer = millis();
-      return (i);
+      unsigned long elapsed = millis() - taskList[i].timer;
+      if (elapsed >= taskList[i].interval)
+      {
+        updateTimer(taskList[i], elapsed);
+#if __USE_WATCHDOG__
+        clk_wdt_record.set(i, clk_wdt_record.failed);
+#endif
+#if defined(USE_TASK_TRACE)
+        uint32_t start = micros();
+#endif
+        taskList[i].callback(taskList[i].context);
+#if defined(USE_TASK_TRACE)
+        clkTrace.add(i, start, micros());
+#endif
+#if __USE_WATCHDOG__
+        clk_wdt_record.set(CLK_INVALID_HANDLE, clk_wdt_record.failed);
+        heartbeat(i);
+#endif
+      }
     }
   }
-  return (CLK_INVALID_HANDLE);
+#if __USE_WATCHDOG__
+  supervise();
+#endif
 }
 
-void clkTaskManager::startTask(clkHandle _handle)
+template <uint8_t N>
+clkHandle clkTaskManager<N>::addTask(unsigned long _interval, clkTaskManagerCallback _callback, bool isActive)
+{
+  if (_callback == nullptr)
+  {
+    return (CLK_INVALID_HANDLE);
+  }
+
+  return (addTask(_interval, clk_plain_task, reinterpret_cast<void *>(_callback), isActive));
+}
+
+template <uint8_t N>
+clkHandle clkTaskManager<N>::addTask(unsigned long _interval, clkTaskCallback _callback, void *_context, bool isActive)
+{
+  if (free_head == CLK_INVALID_HANDLE || _callback == nullptr)
+  {
+    return (CLK_INVALID_HANDLE);
+  }
+
+  clkHandle i = free_head;
+  free_head = next_free[i];
+  free_count--;
+
+  taskList[i].status = isActive;
+  taskList[i].policy = CLK_OVERRUN_CATCH_UP;
+  taskList[i].overruns = 0;
+  taskList[i].behind = false;
+  taskList[i].interval = _interval;
+  taskList[i].callback = _callback;
+  taskList[i].context = _context;
+  taskList[i].timer = millis();
+  return (i);
+}
+
+template <uint8_t N>
+void clkTaskManager<N>::delTask(clkHandle _handle)
+{
+  if (isValidHandle(_handle) && taskList[_handle].callback != nullptr)
+  {
+    taskList[_handle].status = false;
+    taskList[_handle].callback = nullptr;
+    taskList[_handle].context = nullptr;
+    next_free[_handle] = free_head;
+    free_head = _handle;
+    free_count++;
+  }
+}
+
+template <uint8_t N>
+void clkTaskManager<N>::startTask(clkHandle _handle)
 {
   if (isValidHandle(_handle) && taskList[_handle].callback != nullptr)
   {
@@ -144,7 +460,8 @@ void clkTaskManager::startTask(clkHandle _handle)
   }
 }
 
-void clkTaskManager::stopTask(clkHandle _handle)
+template <uint8_t N>
+void clkTaskManager<N>::stopTask(clkHandle _handle)
 {
   if (isValidHandle(_handle))
   {
@@ -152,9 +469,10 @@ void clkTaskManager::stopTask(clkHandle _handle)
   }
 }
 
-bool clkTaskManager::getTaskState(clkHandle _handle)
+template <uint8_t N>
+bool clkTaskManager<N>::getTaskState(clkHandle _handle)
 {
-  if (isValidHandle(_handle) && (taskList != nullptr))
+  if (isValidHandle(_handle))
   {
     return (taskList[_handle].status && taskList[_handle].callback != nullptr);
   }
@@ -162,7 +480,8 @@ bool clkTaskManager::getTaskState(clkHandle _handle)
   return (false);
 }
 
-void clkTaskManager::setTaskInterval(clkHandle _handle, unsigned long _interval, bool _restart)
+template <uint8_t N>
+void clkTaskManager<N>::setTaskInterval(clkHandle _handle, unsigned long _interval, bool _restart)
 {
   if (isValidHandle(_handle))
   {
@@ -175,7 +494,8 @@ void clkTaskManager::setTaskInterval(clkHandle _handle, unsigned long _interval,
   }
 }
 
-void clkTaskManager::taskExes(clkHandle _handle, bool _restart)
+template <uint8_t N>
+void clkTaskManager<N>::taskExes(clkHandle _handle, bool _restart)
 {
   if (isValidHandle(_handle))
   {
@@ -186,16 +506,100 @@ void clkTaskManager::taskExes(clkHandle _handle, bool _restart)
         taskList[_handle].status = true;
         taskList[_handle].timer = millis();
       }
-      taskList[_handle].callback();
+      taskList[_handle].callback(taskList[_handle].context);
+    }
+  }
+}
+
+template <uint8_t N>
+void clkTaskManager<N>::setOverrunPolicy(clkHandle _handle, clkOverrunPolicy _policy)
+{
+  if (isValidHandle(_handle))
+  {
+    taskList[_handle].policy = _policy;
+  }
+}
+
+template <uint8_t N>
+uint16_t clkTaskManager<N>::getOverrunCount(clkHandle _handle)
+{
+  return ((isValidHandle(_handle)) ? taskList[_handle].overruns : 0);
+}
+
+template <uint8_t N>
+void clkTaskManager<N>::clearOverrunCount(clkHandle _handle)
+{
+  if (isValidHandle(_handle))
+  {
+    taskList[_handle].overruns = 0;
+  }
+}
+
+template <uint8_t N>
+uint8_t clkTaskManager<N>::getCapacity() { return (N); }
+
+template <uint8_t N>
+uint8_t clkTaskManager<N>::getFreeCount() { return (free_count); }
+
+#if __USE_WATCHDOG__
+template <uint8_t N>
+bool clkTaskManager<N>::superviseTask(clkHandle _handle, uint16_t _deadline)
+{
+  if (!isValidHandle(_handle))
+  {
+    return (false);
+  }
+
+  for (uint8_t i = 0; i < watch_count; i++)
+  {
+    if (watch[i].handle == _handle)
+    {
+      if (_deadline == 0)
+      {
+        watch[i] = watch[--watch_count];
+      }
+      else
+      {
+        watch[i].deadline = _deadline;
+        watch[i].beat = millis();
+      }
+      return (true);
     }
   }
+
+  if (_deadline == 0)
+  {
+    return (true);
+  }
+  if (watch_count >= WATCHDOG_TASK_COUNT)
+  {
+    return (false);
+  }
+
+  watch[watch_count].handle = _handle;
+  watch[watch_count].deadline = _deadline;
+  watch[watch_count].beat = millis();
+  watch_count++;
+  return (true);
 }
 
-void clkTaskManager::setAddTaskCount(uint8_t _add_count)
+template <uint8_t N>
+void clkTaskManager<N>::heartbeat(clkHandle _handle)
 {
-  add_task_count = _add_count;
+  for (uint8_t i = 0; i < watch_count; i++)
+  {
+    if (watch[i].handle == _handle)
+    {
+      watch[i].beat = millis();
+      return;
+    }
+  }
 }
 
+template <uint8_t N>
+clkHandle clkTaskManager<N>::getLastFailedTask() { return (last_failed); }
+#endif
+
 // ==== end clkTaskManager ===========================
 
-clkTaskManager clkTasks;
+clkTaskManager<CLK_TASK_COUNT> clkTasks;
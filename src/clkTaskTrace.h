@@ -0,0 +1,115 @@
+/**
+ * @file clkTaskTrace.h
+ * @author Vladimir Shatalov (valesh-soft@yandex.ru)
+ *
+ * @brief трассировка срабатываний задач диспетчера задач
+ *
+ * @version 1.0
+ * @date 19.10.2026
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#pragma once
+#include <Arduino.h>
+
+// ==== clkTaskTrace =================================
+
+/*
+ * для каждого срабатывания задачи clkTaskManager::tick() записывает в
+ * кольцевой буфер номер задачи и время начала и конца ее работы (micros());
+ * при заполнении буфера самые старые записи затираются, т.е. в буфере всегда
+ * хранятся последние TRACE_BUFFER_SIZE срабатываний;
+ *
+ * содержимое буфера выводится методом shSimpleClock::dumpTaskTrace() в
+ * текстовом виде, который понимает любой монитор порта:
+ *   #clktrace 1              - заголовок и версия формата
+ *   #lost <n>                - количество затертых записей
+ *   @<задача> <имя>          - имена штатных задач
+ *   <задача> <начало> <конец> - записи, от старых к новым
+ *   #end
+ * утилита tools/clktrace2json.py преобразует такой вывод в формат
+ * Chrome trace / Perfetto
+ */
+
+#if !defined(TRACE_BUFFER_SIZE)
+#define TRACE_BUFFER_SIZE 64 // количество записей в буфере трассировки
+#endif
+
+struct clkTraceRecord
+{
+  uint32_t start; // начало работы задачи, micros()
+  uint32_t end;   // конец работы задачи, micros()
+  int8_t task;    // идентификатор задачи
+};
+
+class clkTaskTrace
+{
+private:
+  static_assert(TRACE_BUFFER_SIZE > 0 && TRACE_BUFFER_SIZE <= 255, "the trace buffer size must be in the range 1..255");
+
+  clkTraceRecord records[TRACE_BUFFER_SIZE];
+  uint8_t head = 0;  // ячейка для следующей записи
+  uint8_t count = 0; // количество записей в буфере
+  uint16_t lost = 0; // количество затертых записей
+  bool active = true;
+
+public:
+  clkTaskTrace() {}
+
+  void add(int8_t _task, uint32_t _start, uint32_t _end)
+  {
+    if (!active)
+    {
+      return;
+    }
+
+    records[head].start = _start;
+    records[head].end = _end;
+    records[head].task = _task;
+    head = (head + 1) % TRACE_BUFFER_SIZE;
+    if (count < TRACE_BUFFER_SIZE)
+    {
+      count++;
+    }
+    else if (lost < 0xFFFF)
+    {
+      lost++;
+    }
+  }
+
+  /**
+   * @brief включение и приостановка записи; например, чтобы сохранить в буфере интересующий участок
+   *
+   * @param _active
+   */
+  void setActive(bool _active) { active = _active; }
+
+  bool isActive() { return (active); }
+
+  uint8_t getCount() { return (count); }
+
+  uint16_t getLostCount() { return (lost); }
+
+  /**
+   * @brief получение записи
+   *
+   * @param _num номер записи, 0 - самая старая
+   * @return const clkTraceRecord&
+   */
+  const clkTraceRecord &get(uint8_t _num)
+  {
+    return (records[(head + TRACE_BUFFER_SIZE - count + _num) % TRACE_BUFFER_SIZE]);
+  }
+
+  void clear()
+  {
+    head = 0;
+    count = 0;
+    lost = 0;
+  }
+};
+
+// ==== end clkTaskTrace =============================
+
+clkTaskTrace clkTrace;
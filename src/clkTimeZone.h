@@ -0,0 +1,362 @@
+/**
+ * @file clkTimeZone.h
+ * @author Vladimir Shatalov (valesh-soft@yandex.ru)
+ *
+ * @brief часовой пояс и переход на летнее время по правилу в формате POSIX TZ
+ *
+ * @version 1.0
+ * @date 19.10.2026
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#pragma once
+
+// ==== clkTimeZone ==================================
+
+/*
+ * правило задается строкой в формате переменной окружения TZ стандарта POSIX:
+ *   std offset [dst [offset] ,start[/time],end[/time]]
+ * например:
+ *   "MSK-3"                        - Москва, UTC+3, без летнего времени;
+ *   "CET-1CEST,M3.5.0,M10.5.0/3"   - Центральная Европа;
+ *   "EST5EDT,M3.2.0,M11.1.0"       - восточное побережье США;
+ * знак смещения в POSIX обратный: "-1" означает UTC+1;
+ * поддерживаются только правила перехода вида Mm.w.d (месяц, неделя месяца
+ * 1..5, где 5 - последняя, день недели 0..6, 0 - воскресенье); время
+ * перехода по умолчанию - 02:00 местного времени;
+ *
+ * для ускорения пересчета хранится интервал UTC, в пределах которого
+ * смещение не меняется (между соседними переходами); пока время находится
+ * внутри интервала, пересчет в местное время - это одно сравнение и одно
+ * сложение; при выходе за границы интервала вычисляются следующие переходы
+ */
+
+#if !defined(TIME_ZONE_RULE)
+#define TIME_ZONE_RULE "UTC0"
+#endif
+
+struct clkTzRule
+{
+  uint8_t month; // месяц перехода, 1..12
+  uint8_t week;  // неделя месяца, 1..5; 5 - последняя неделя месяца
+  uint8_t dow;   // день недели, 0 - воскресенье
+  int32_t time;  // время перехода, секунд от полуночи местного времени
+};
+
+class clkTimeZone
+{
+private:
+  int32_t std_offset = 0;    // смещение стандартного времени относительно UTC, с
+  int32_t dst_offset = 0;    // смещение летнего времени относительно UTC, с
+  bool use_dst = false;      // используется ли переход на летнее время
+  clkTzRule dst_start;       // правило перехода на летнее время
+  clkTzRule dst_end;         // правило возврата на стандартное время
+  uint32_t range_start = 0;  // начало интервала UTC, в котором действует cur_offset
+  uint32_t range_end = 0;    // конец интервала UTC (не включительно)
+  int32_t cur_offset = 0;    // текущее смещение относительно UTC, с
+  bool cur_dst = false;      // летнее ли время в текущем интервале
+
+  bool parseName(const char *&p);
+
+  bool parseNumber(const char *&p, int32_t &_num, uint8_t _max_digits);
+
+  bool parseTime(const char *&p, int32_t &_sec);
+
+  bool parseRule(const char *&p, clkTzRule &_rule);
+
+  uint32_t getTransition(uint16_t _year, const clkTzRule &_rule, int32_t _offset);
+
+  void update(uint32_t _utc);
+
+public:
+  clkTimeZone() {}
+
+  /**
+   * @brief установка правила часового пояса
+   *
+   * @param _tz строка в формате POSIX TZ, например, "CET-1CEST,M3.5.0,M10.5.0/3"
+   * @return true, если строка разобрана успешно; иначе часовой пояс сбрасывается в UTC
+   */
+  bool setRule(const char *_tz);
+
+  /**
+   * @brief пересчет времени UTC в местное время
+   *
+   * @param _utc время UTC в секундах с 01.01.1970
+   * @return uint32_t местное время в секундах с 01.01.1970
+   */
+  uint32_t toLocal(uint32_t _utc);
+
+  /**
+   * @brief пересчет местного времени в UTC; для неоднозначного часа при возврате на стандартное время выбирается стандартное время
+   *
+   * @param _local местное время в секундах с 01.01.1970
+   * @return uint32_t время UTC в секундах с 01.01.1970
+   */
+  uint32_t toUtc(uint32_t _local);
+
+  /**
+   * @brief действует ли летнее время в заданный момент
+   *
+   * @param _utc время UTC в секундах с 01.01.1970
+   * @return true
+   * @return false
+   */
+  bool isDst(uint32_t _utc);
+
+  /**
+   * @brief время UTC ближайшего перехода на летнее или стандартное время после заданного момента
+   *
+   * @param _utc время UTC в секундах с 01.01.1970
+   * @return uint32_t; 0xFFFFFFFF, если переход на летнее время не используется
+   */
+  uint32_t getNextTransition(uint32_t _utc);
+};
+
+// ---- clkTimeZone private ---------------------
+
+bool clkTimeZone::parseName(const char *&p)
+{
+  uint8_t len = 0;
+  if (*p == '<')
+  {
+    // имя в угловых скобках может содержать цифры и знаки, например, <+03>
+    while (*++p && *p != '>')
+    {
+      len++;
+    }
+    if (*p != '>')
+    {
+      return (false);
+    }
+    p++;
+  }
+  else
+  {
+    while ((*p >= 'A' && *p <= 'Z') || (*p >= 'a' && *p <= 'z'))
+    {
+      p++;
+      len++;
+    }
+  }
+  return (len >= 3);
+}
+
+bool clkTimeZone::parseNumber(const char *&p, int32_t &_num, uint8_t _max_digits)
+{
+  uint8_t n = 0;
+  _num = 0;
+  while (*p >= '0' && *p <= '9' && n < _max_digits)
+  {
+    _num = _num * 10 + (*p++ - '0');
+    n++;
+  }
+  return (n > 0);
+}
+
+bool clkTimeZone::parseTime(const char *&p, int32_t &_sec)
+{
+  bool neg = (*p == '-');
+  if (*p == '-' || *p == '+')
+  {
+    p++;
+  }
+
+  int32_t x;
+  if (!parseNumber(p, x, 3))
+  {
+    return (false);
+  }
+  _sec = x * 3600;
+  for (uint8_t i = 0; i < 2 && *p == ':'; i++)
+  {
+    p++;
+    if (!parseNumber(p, x, 2))
+    {
+      return (false);
+    }
+    _sec += (i == 0) ? x * 60 : x;
+  }
+  if (neg)
+  {
+    _sec = -_sec;
+  }
+  return (true);
+}
+
+bool clkTimeZone::parseRule(const char *&p, clkTzRule &_rule)
+{
+  int32_t m, w, d;
+  if (*p++ != 'M' ||
+      !parseNumber(p, m, 2) || *p++ != '.' ||
+      !parseNumber(p, w, 1) || *p++ != '.' ||
+      !parseNumber(p, d, 1) ||
+      m < 1 || m > 12 || w < 1 || w > 5 || d > 6)
+  {
+    return (false);
+  }
+  _rule.month = m;
+  _rule.week = w;
+  _rule.dow = d;
+  _rule.time = 7200l;
+  if (*p == '/')
+  {
+    p++;
+    return (parseTime(p, _rule.time));
+  }
+  return (true);
+}
+
+uint32_t clkTimeZone::getTransition(uint16_t _year, const clkTzRule &_rule, int32_t _offset)
+{
+  // первый заданный день недели в месяце, затем нужная неделя; 5-я неделя - последняя
+  uint8_t first = clkDateTime(_year, _rule.month, 1).dayOfTheWeek();
+  uint8_t day = 1 + (_rule.dow + 7 - first) % 7 + (_rule.week - 1) * 7;
+  while (day > getDaysInMonth(_rule.month, _year))
+  {
+    day -= 7;
+  }
+
+  // время перехода задано по местному времени, действовавшему до перехода
+  return (clkDateTime(_year, _rule.month, day).unixtime() + _rule.time - _offset);
+}
+
+void clkTimeZone::update(uint32_t _utc)
+{
+  if (!use_dst)
+  {
+    cur_offset = std_offset;
+    cur_dst = false;
+    range_start = 0;
+    range_end = 0xFFFFFFFF;
+    return;
+  }
+
+  uint16_t y = clkDateTime(_utc).year();
+  uint32_t s = getTransition(y, dst_start, std_offset);
+  uint32_t e = getTransition(y, dst_end, dst_offset);
+
+  if (s < e)
+  {
+    // северное полушарие: летнее время внутри года
+    if (_utc < s)
+    {
+      range_start = getTransition(y - 1, dst_end, dst_offset);
+      range_end = s;
+      cur_dst = false;
+    }
+    else if (_utc < e)
+    {
+      range_start = s;
+      range_end = e;
+      cur_dst = true;
+    }
+    else
+    {
+      range_start = e;
+      range_end = getTransition(y + 1, dst_start, std_offset);
+      cur_dst = false;
+    }
+  }
+  else
+  {
+    // южное полушарие: летнее время на стыке годов
+    if (_utc < e)
+    {
+      range_start = getTransition(y - 1, dst_start, std_offset);
+      range_end = e;
+      cur_dst = true;
+    }
+    else if (_utc < s)
+    {
+      range_start = e;
+      range_end = s;
+      cur_dst = false;
+    }
+    else
+    {
+      range_start = s;
+      range_end = getTransition(y + 1, dst_end, dst_offset);
+      cur_dst = true;
+    }
+  }
+  cur_offset = (cur_dst) ? dst_offset : std_offset;
+}
+
+// ---- clkTimeZone public ----------------------
+
+bool clkTimeZone::setRule(const char *_tz)
+{
+  const char *p = _tz;
+  int32_t x;
+
+  use_dst = false;
+  std_offset = 0;
+  bool result = (p != nullptr) && parseName(p) && parseTime(p, x);
+  if (result)
+  {
+    std_offset = -x;
+    dst_offset = std_offset + 3600;
+    if (*p)
+    {
+      // летнее время: имя, необязательное смещение и правила перехода
+      result = parseName(p);
+      if (result && *p != ',' && *p)
+      {
+        result = parseTime(p, x);
+        dst_offset = -x;
+      }
+      result = result &&
+               *p++ == ',' && parseRule(p, dst_start) &&
+               *p++ == ',' && parseRule(p, dst_end) &&
+               *p == 0;
+      use_dst = result;
+    }
+  }
+  if (!result)
+  {
+    std_offset = 0;
+  }
+
+  // сбросить интервал, чтобы смещение было пересчитано при первом же обращении
+  range_start = 1;
+  range_end = 0;
+
+  return (result);
+}
+
+uint32_t clkTimeZone::toLocal(uint32_t _utc)
+{
+  if (_utc < range_start || _utc >= range_end)
+  {
+    update(_utc);
+  }
+  return (_utc + cur_offset);
+}
+
+uint32_t clkTimeZone::toUtc(uint32_t _local)
+{
+  uint32_t utc = _local - std_offset;
+  if (use_dst && isDst(utc))
+  {
+    utc = _local - dst_offset;
+  }
+  return (utc);
+}
+
+bool clkTimeZone::isDst(uint32_t _utc)
+{
+  toLocal(_utc);
+  return (cur_dst);
+}
+
+uint32_t clkTimeZone::getNextTransition(uint32_t _utc)
+{
+  toLocal(_utc);
+  return (range_end);
+}
+
+// ==== end clkTimeZone ==============================
+
+clkTimeZone clkTZ;
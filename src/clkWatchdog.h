@@ -0,0 +1,175 @@
+/**
+ * @file clkWatchdog.h
+ * @author Vladimir Shatalov (valesh-soft@yandex.ru)
+ *
+ * @brief аппаратный сторожевой таймер и запись о сбое, переживающая перезагрузку
+ *
+ * @version 1.0
+ * @date 19.10.2026
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#pragma once
+#include <Arduino.h>
+
+// ==== clkWatchdog ==================================
+
+/*
+ * сторожевой таймер сбрасывается диспетчером задач (см. clkTaskManager::tick())
+ * только тогда, когда все контролируемые задачи отметились в пределах своего
+ * срока; если задача зависла или перестала срабатывать, таймер не сбрасывается
+ * и микроконтроллер перезагружается;
+ *
+ * номер задачи, приведшей к перезагрузке, сохраняется в области RAM, которая
+ * не очищается при старте программы:
+ *   AVR    - секция .noinit;
+ *   ESP32  - RTC_NOINIT_ATTR (память RTC);
+ *   RP2040 - секция .uninitialized_data;
+ * после включения питания содержимое этой области случайно, поэтому запись
+ * защищена сигнатурой и контрольным байтом; кроме того, запись принимается
+ * только после перезагрузки именно сторожевым таймером - иначе кнопка сброса
+ * или просадка питания во время долгой задачи выдавались бы за ее зависание
+ */
+
+#if !defined(WATCHDOG_TIMEOUT)
+#define WATCHDOG_TIMEOUT 4000ul // время до перезагрузки, если сторожевой таймер не сбрасывается, мс
+#endif
+
+#if defined(__AVR__)
+#include <avr/wdt.h>
+#define CLK_NOINIT __attribute__((section(".noinit")))
+#elif defined(ARDUINO_ARCH_ESP32)
+#include <esp_idf_version.h>
+#include <esp_system.h>
+#include <esp_task_wdt.h>
+#define CLK_NOINIT RTC_NOINIT_ATTR
+#elif defined(ARDUINO_ARCH_RP2040)
+#include <hardware/watchdog.h>
+#define CLK_NOINIT __attribute__((section(".uninitialized_data")))
+#endif
+
+static const uint16_t CLK_WDT_SIGNATURE = 0x5744;
+
+struct clkWdtRecord
+{
+  uint16_t signature;
+  int8_t running; // задача, выполнявшаяся в данный момент
+  int8_t failed;  // задача, пропустившая срок
+  uint8_t check;  // контрольный байт
+
+  uint8_t getCheck() volatile { return ((uint8_t)(~(running ^ failed))); }
+
+  bool isValid() volatile { return (signature == CLK_WDT_SIGNATURE && check == getCheck()); }
+
+  void set(int8_t _running, int8_t _failed) volatile
+  {
+    running = _running;
+    failed = _failed;
+    check = getCheck();
+    signature = CLK_WDT_SIGNATURE;
+  }
+};
+
+CLK_NOINIT volatile clkWdtRecord clk_wdt_record;
+
+#if defined(__AVR__)
+/*
+ * после перезагрузки сторожевым таймером на AVR он остается включенным с
+ * минимальным периодом 16 мс, и без его отключения контроллер перезагружался
+ * бы снова и снова, не дойдя до clk_wdt_begin(); поэтому таймер отключается
+ * в секции .init3, до инициализации переменных и вызова конструкторов;
+ * флаги причины сброса при этом сохраняются; optiboot сам сбрасывает MCUSR,
+ * передавая его прежнее значение в регистре r2
+ */
+CLK_NOINIT uint8_t clk_reset_flags; // .bss очищается позже, в .init4
+
+void clk_wdt_init3() __attribute__((naked, used, section(".init3")));
+void clk_wdt_init3()
+{
+  uint8_t r2;
+  __asm__ volatile("mov %0, r2" : "=r"(r2));
+  uint8_t flags = MCUSR;
+  clk_reset_flags = (flags) ? flags : r2;
+  MCUSR = 0;
+  wdt_disable();
+}
+#endif
+
+/**
+ * @brief была ли последняя перезагрузка вызвана сторожевым таймером
+ *
+ * @return true
+ * @return false
+ */
+bool clk_wdt_caused_reset()
+{
+#if defined(__AVR__)
+  return (clk_reset_flags & _BV(WDRF));
+#elif defined(ARDUINO_ARCH_ESP32)
+  esp_reset_reason_t reason = esp_reset_reason();
+  return (reason == ESP_RST_TASK_WDT || reason == ESP_RST_INT_WDT);
+#elif defined(ARDUINO_ARCH_RP2040)
+  // watchdog_caused_reboot() истинно и после программной перезагрузки
+  // (watchdog_reboot(), rp2040.reboot(), picotool), а нужно только срабатывание
+  // таймера, запущенного watchdog_enable()
+  return (watchdog_enable_caused_reboot());
+#else
+  return (false);
+#endif
+}
+
+/**
+ * @brief включение аппаратного сторожевого таймера
+ *
+ */
+void clk_wdt_begin()
+{
+#if defined(__AVR__)
+#if WATCHDOG_TIMEOUT >= 8000 && defined(WDTO_8S)
+  wdt_enable(WDTO_8S);
+#elif WATCHDOG_TIMEOUT >= 4000 && defined(WDTO_4S)
+  wdt_enable(WDTO_4S);
+#elif WATCHDOG_TIMEOUT >= 2000
+  wdt_enable(WDTO_2S);
+#elif WATCHDOG_TIMEOUT >= 1000
+  wdt_enable(WDTO_1S);
+#else
+  wdt_enable(WDTO_500MS);
+#endif
+#elif defined(ARDUINO_ARCH_ESP32)
+#if ESP_IDF_VERSION_MAJOR >= 5
+  esp_task_wdt_config_t cfg;
+  cfg.timeout_ms = WATCHDOG_TIMEOUT;
+  cfg.idle_core_mask = 0;
+  cfg.trigger_panic = true;
+  // ядро arduino-esp32 обычно уже запустило таймер задач - тогда меняются только его настройки
+  if (esp_task_wdt_reconfigure(&cfg) != ESP_OK)
+  {
+    esp_task_wdt_init(&cfg);
+  }
+#else
+  esp_task_wdt_init((WATCHDOG_TIMEOUT + 999) / 1000, true);
+#endif
+  esp_task_wdt_add(NULL);
+#elif defined(ARDUINO_ARCH_RP2040)
+  watchdog_enable(WATCHDOG_TIMEOUT, true);
+#endif
+}
+
+/**
+ * @brief сброс аппаратного сторожевого таймера
+ *
+ */
+void clk_wdt_feed()
+{
+#if defined(__AVR__)
+  wdt_reset();
+#elif defined(ARDUINO_ARCH_ESP32)
+  esp_task_wdt_reset();
+#elif defined(ARDUINO_ARCH_RP2040)
+  watchdog_update();
+#endif
+}
+
+// ==== end clkWatchdog ==============================
@@ -12,10 +12,10 @@
 // используется или нет вывод температуры; вывод температуры доступен, если:
 //   - задан флаг USE_TEMP_DATA и:
 //     - либо задано использование одного из датчиков и пин для датчика,
-//     - либо используется RTC модуль DS3231
+//     - либо используется RTC модуль DS3231 (или включено автоопределение RTC)
 #if defined(USE_TEMP_DATA) && ((defined(USE_DS18B20) && DS18B20_PIN >= 0) || \
                                (defined(USE_NTC) && NTC_PIN >= 0) ||         \
-                               defined(RTC_DS3231))
+                               defined(RTC_DS3231) || defined(RTC_AUTO_DETECT))
 #define __USE_TEMP_DATA__ 1
 #else
 #define __USE_TEMP_DATA__ 0
@@ -61,6 +61,26 @@
 #define __USE_MATRIX_DISPLAY__ 0
 #endif
 
+// размер матрицы; по умолчанию - 8х32
+#if __USE_MATRIX_DISPLAY__
+#if !defined(MATRIX_WIDTH)
+#define MATRIX_WIDTH 32
+#endif
+#if !defined(MATRIX_HEIGHT)
+#define MATRIX_HEIGHT 8
+#endif
+#endif
+
+// на матрице хватает места для одновременного вывода времени и даты:
+//   - при высоте матрицы от 16 строк дата выводится во второй строке;
+//   - при ширине матрицы от 64 столбцов дата выводится справа от времени;
+#if __USE_MATRIX_DISPLAY__ && defined(USE_CALENDAR) && \
+    (MATRIX_HEIGHT >= 16 || MATRIX_WIDTH >= 64)
+#define __USE_DATE_WITH_TIME__ 1
+#else
+#define __USE_DATE_WITH_TIME__ 0
+#endif
+
 // используются семисегментные индикаторы
 #if defined(MAX72XX_7SEGMENT_DISPLAY) || defined(TM1637_DISPLAY)
 #define __USE_7SEMENT_DISPLAY__ 1
@@ -87,6 +107,55 @@
 #define __USE_EEPROM_IN_FLASH__ 0
 #endif
 
+// используется ли отложенная запись в EEPROM (esp32, esp8266, rp2040, stm32duino):
+//   - изменения накапливаются в буфере и записываются во флеш одним пакетом
+#if __USE_EEPROM_IN_FLASH__ || defined(ARDUINO_ARCH_STM32)
+#define __USE_EEPROM_WRITE_BEHIND__ 1
+#else
+#define __USE_EEPROM_WRITE_BEHIND__ 0
+#endif
+
+// хранятся ли настройки в журнале (только AVR):
+//   - журнал распределяет запись по ячейкам настоящей EEPROM; там, где EEPROM
+//     эмулируется во флеш-памяти (esp32, esp8266, rp2040, stm32), при каждой
+//     фиксации изменений стирается весь сектор эмуляции, поэтому журнал износ
+//     не уменьшает, и опция USE_SETTINGS_LOG игнорируется
+#if defined(USE_SETTINGS_LOG) && defined(__AVR__)
+#define __USE_SETTINGS_LOG__ 1
+#else
+#define __USE_SETTINGS_LOG__ 0
+#endif
+
+// используется ли программная коррекция хода RTC (для модулей без регистра подстройки частоты):
+//   - поправка хранится в EEPROM
+//   - при автоопределении RTC модуль заранее неизвестен, поэтому поправка предусматривается всегда
+#if defined(USE_RTC_CALIBRATION) && (defined(RTC_DS1307) || defined(RTC_PCF8563) || defined(RTC_AUTO_DETECT))
+#define __USE_RTC_SOFT_CALIBRATION__ 1
+#else
+#define __USE_RTC_SOFT_CALIBRATION__ 0
+#endif
+
+// выводится ли изображение на отдельном ядре (esp32 с двумя ядрами, rp2040):
+//   - только для матрицы из адресных светодиодов - вывод кадра на нее самая долгая операция
+//   - на одноядерных контроллерах опция USE_DUAL_CORE игнорируется
+#if defined(USE_DUAL_CORE) && defined(WS2812_MATRIX_DISPLAY) && \
+    ((defined(ARDUINO_ARCH_ESP32) && !defined(CONFIG_FREERTOS_UNICORE)) || defined(ARDUINO_ARCH_RP2040))
+#define __USE_DUAL_CORE__ 1
+#else
+#define __USE_DUAL_CORE__ 0
+#endif
+
+// используется ли контроль задач сторожевым таймером (avr, esp32, rp2040):
+//   - на остальных платформах опция USE_WATCHDOG игнорируется
+#if defined(USE_WATCHDOG) && (defined(__AVR__) || defined(ARDUINO_ARCH_ESP32) || defined(ARDUINO_ARCH_RP2040))
+#define __USE_WATCHDOG__ 1
+#if !defined(WATCHDOG_TASK_DEADLINE)
+#define WATCHDOG_TASK_DEADLINE 2000 // срок отметки для опроса RTC, блинка и вывода на экран, мс
+#endif
+#else
+#define __USE_WATCHDOG__ 0
+#endif
+
 // ===================================================
 
 #include <Arduino.h>
@@ -99,7 +168,13 @@
 #include "_eeprom.h"
 #include "clkSimpleRTC.h"
 #include "clkTaskManager.h"
+#include "clkEventBus.h"
 #include "clkButtons.h"
+#include "clkCronTask.h"
+#include "clkCoroutine.h"
+#if defined(USE_RTC_CALIBRATION)
+#include "clkRtcCalibration.h"
+#endif
 
 // ===================================================
 
@@ -216,9 +291,12 @@ void sscShowTimeSetting();
 void sscShowDisplay();
 void sscCheckButton();
 void sscSetDisplayMode();
+void sscChangeDisplayMode(clkDisplayMode _mode);
 #if defined(USE_ALARM)
 void sscCheckAlarm();
-void sscRunAlarmBuzzer();
+void sscAlarmTrigger();
+void sscRunAlarmBuzzer(void *_state);
+void sscSetAlarmSchedule();
 #endif
 #if __USE_LIGHT_SENSOR__
 void sscSetBrightness();
@@ -226,7 +304,7 @@ void sscSetBrightness();
 #if __USE_TEMP_DATA__
 int8_t sscGetCurTemp();
 #if defined(USE_DS18B20)
-void sscCheckDS18b20();
+void sscCheckDS18b20(void *_state);
 #endif
 #endif
 void sscClearButtonFlag();
@@ -235,8 +313,10 @@ void sscStopSetting(clkHandle task);
 void sscShowOtherSetting();
 #endif
 #if __USE_AUTO_SHOW_DATA__
-void sscAutoShowData();
+void sscAutoShowData(void *_state);
 uint8_t sscGetPeriodForAutoShow(uint8_t index);
+void sscStartAutoShow();
+void sscSetAutoShowSchedule();
 #endif
 #if __USE_ON_OFF_DATA__
 void sscShowOnOffData(clkDataType _type, bool _state, bool blink);
@@ -244,29 +324,73 @@ void sscShowOnOffData(clkDataType _type, bool _state, bool blink);
 
 #if __USE_MATRIX_DISPLAY__
 
-void sscSetTimeString(uint8_t offset, int8_t hour, int8_t minute, bool show_colon,
-                      bool toDate, bool toStringData = false);
-void sscSetOtherDataString(clkDataType _type, uint8_t offset, uint8_t _data, bool blink,
+// данные формируются в блоке шириной 32 столбца, который выравнивается по центру экрана
+#if __USE_DATE_WITH_TIME__ && MATRIX_HEIGHT < 16
+uint16_t constexpr MATRIX_DATA_OFFSET = (MATRIX_WIDTH - 64) / 2; // смещение блока данных от левого края экрана
+uint16_t constexpr MATRIX_DATE_OFFSET = 32;                      // смещение даты относительно блока данных
+uint8_t constexpr MATRIX_DATE_LINE = 0;                          // строка экрана для вывода даты
+#else
+uint16_t constexpr MATRIX_DATA_OFFSET = (MATRIX_WIDTH - 32) / 2;
+#if __USE_DATE_WITH_TIME__
+uint16_t constexpr MATRIX_DATE_OFFSET = 0;
+uint8_t constexpr MATRIX_DATE_LINE = 1;
+#endif
+#endif
+
+#if defined(SHOW_SECOND_COLUMN)
+// секундный столбик выводится в крайнем правом столбце экрана; номер столбца - относительно блока данных
+uint16_t constexpr MATRIX_SECOND_COLUMN = MATRIX_WIDTH - 1 - MATRIX_DATA_OFFSET;
+#endif
+
+// проверка геометрии экрана
+static_assert(MATRIX_WIDTH >= 32, "MATRIX_WIDTH must be at least 32");
+static_assert(MATRIX_HEIGHT >= 8 && MATRIX_HEIGHT % 8 == 0, "MATRIX_HEIGHT must be a multiple of 8");
+#if defined(MAX72XX_MATRIX_DISPLAY)
+static_assert(MATRIX_WIDTH % 8 == 0, "MATRIX_WIDTH must be a multiple of 8 for MAX72xx modules");
+#endif
+static_assert(MATRIX_DATA_OFFSET + 32 <= MATRIX_WIDTH, "the data block does not fit the matrix");
+#if __USE_DATE_WITH_TIME__
+static_assert(MATRIX_DATA_OFFSET + MATRIX_DATE_OFFSET + 32 <= MATRIX_WIDTH, "the date block does not fit the matrix");
+static_assert(MATRIX_DATE_LINE * 8 < MATRIX_HEIGHT, "the date line does not fit the matrix");
+#endif
+#if defined(SHOW_SECOND_COLUMN)
+// столбец не должен попадать на цифры времени, занимающие столбцы 0..30 блока данных
+static_assert(MATRIX_SECOND_COLUMN >= 31 && MATRIX_SECOND_COLUMN + MATRIX_DATA_OFFSET == MATRIX_WIDTH - 1,
+              "the second column must be at the right edge of the matrix");
+#endif
+
+void sscSetTimeString(uint16_t offset, int8_t hour, int8_t minute, bool show_colon,
+                      bool toDate, bool toStringData = false, uint8_t line = 0);
+void sscSetOtherDataString(clkDataType _type, uint16_t offset, uint8_t _data, bool blink,
                            bool toStringData = false);
-void sscSetTag(uint8_t offset, uint8_t index, uint8_t width, bool toStringData);
-void sscSetOnOffDataString(clkDataType _type, uint8_t offset, bool _state, bool _blink,
+void sscSetTag(uint16_t offset, uint8_t index, uint8_t width, bool toStringData);
+void sscSetOnOffDataString(clkDataType _type, uint16_t offset, bool _state, bool _blink,
                            bool toStringData = false);
-void sscSetNumString(uint8_t offset, uint8_t num,
-                     uint8_t width = 6, uint8_t space = 1, bool toStringData = false, bool firstSpace = false);
-void sscSetChar(uint8_t offset, uint8_t chr, uint8_t width, bool toStringData = false);
+void sscSetNumString(uint16_t offset, uint8_t num,
+                     uint8_t width = 6, uint8_t space = 1, bool toStringData = false, bool firstSpace = false,
+                     uint8_t line = 0);
+void sscSetChar(uint16_t offset, uint8_t chr, uint8_t width, bool toStringData = false, uint8_t line = 0);
+void sscSetColumn(uint16_t col, uint8_t _data, bool toStringData = false, uint8_t line = 0);
 
 #if defined(USE_TICKER_FOR_DATA)
-void sscAssembleString(clkDisplayMode data_type, uint8_t lenght = 80);
-void sscRunTicker();
+void sscAssembleString(clkDisplayMode data_type, uint16_t lenght = MATRIX_WIDTH + 48);
+void sscRunTicker(void *_state);
+#endif
+
+#if defined(USE_DIGIT_ANIMATION)
+void sscCheckDigitAnimation(uint8_t offset, int8_t hour, int8_t minute);
+void sscSetDigitAnimationFrame();
+void sscRunDigitAnimation();
+void sscStopDigitAnimation();
 #endif
 
 #if defined(USE_CALENDAR)
-void sscSetDayOfWeakString(uint8_t offset, uint8_t dow, bool toStringData = false);
-void sscSetYearString(uint8_t offset, int16_t _year, bool toStringData = false);
+void sscSetDayOfWeakString(uint16_t offset, uint8_t dow, bool toStringData = false);
+void sscSetYearString(uint16_t offset, uint8_t _century, int8_t _year, bool toStringData = false);
 #endif
 
 #if __USE_TEMP_DATA__
-void sscSetTempString(uint8_t offset, int16_t temp, bool toStringData = false);
+void sscSetTempString(uint16_t offset, int16_t temp, bool toStringData = false);
 #endif
 
 #if defined(WS2812_MATRIX_DISPLAY)
@@ -292,6 +416,49 @@ void sscShowTemp(int temp);
 bool sscBlinkFlag = false; // флаг блинка, используется всем, что должно мигать
 
 clkDisplayMode ssc_display_mode = DISPLAY_MODE_SHOW_TIME;
+// режим экрана изменился, и задачи режима нужно проверить; в отличие от
+// события CLK_EV_MODE, флаг не может потеряться при переполнении очереди событий
+bool ssc_display_mode_changed = false;
+
+// состояния задач, передаваемые их функциям как контекст
+
+#if __USE_TEMP_DATA__ && defined(USE_DS18B20)
+struct sscDS18b20State
+{
+  clkCoroutine co; // ожидание результата измерения
+} ssc_ds18b20_state;
+#endif
+
+#if defined(USE_ALARM)
+// длительности нот "мелодии" пищалки кратны интервалу ее задачи, поэтому
+// ноты отсчитываются срабатываниями задачи, без опроса millis() на каждой
+uint8_t constexpr SSC_BUZZER_INTERVAL = 70;
+
+struct sscBuzzerState
+{
+  clkCoroutine co; // точка продолжения "мелодии"
+  uint8_t note;    // номер ноты в "мелодии"
+  uint8_t wait;    // оставшаяся длительность ноты, срабатываний задачи
+  uint8_t cycle;   // количество проигранных "мелодий" за текущее срабатывание
+  uint8_t repeat;  // количество срабатываний
+} ssc_buzzer_state;
+#endif
+
+#if __USE_AUTO_SHOW_DATA__
+struct sscAutoShowState
+{
+  uint8_t n;           // номер текущего выводимого экрана
+  uint8_t n_max;       // номер последнего экрана
+  unsigned long timer; // время смены экрана
+} ssc_auto_show_state;
+#endif
+
+#if defined(USE_TICKER_FOR_DATA)
+struct sscTickerState
+{
+  uint16_t pos; // смещение строки относительно левого края экрана
+} ssc_ticker_state;
+#endif
 
 // ===================================================
 
@@ -352,8 +519,6 @@ private:
 
   void rtc_init();
 
-  void eeprom_validate();
-
   void sensor_init();
 
   void display_init();
@@ -397,6 +562,35 @@ public:
    */
   void tick();
 
+  /**
+   * @brief немедленная запись во флеш накопленных изменений настроек (esp32, esp8266, rp2040, stm32) и контрольной суммы настроек; на остальных контроллерах сами настройки записываются в EEPROM сразу
+   *
+   */
+  void flushSettings();
+
+#if __USE_SETTINGS_LOG__
+  /**
+   * @brief количество уплотнений журнала настроек с момента его создания; при каждом уплотнении перезаписывается одна из двух страниц журнала
+   *
+   * @return uint32_t
+   */
+  uint32_t getSettingsCompactionCount();
+
+  /**
+   * @brief количество ячеек EEPROM, перезаписанных журналом настроек с момента старта
+   *
+   * @return uint32_t
+   */
+  uint32_t getSettingsBytesWritten();
+
+  /**
+   * @brief коэффициент усиления записи журнала настроек с момента старта - отношение количества перезаписанных ячеек EEPROM к объему изменившихся данных настроек
+   *
+   * @return uint16_t значение в сотых долях, т.е. 100 - запись без усиления; 0 - настройки с момента старта не изменялись
+   */
+  uint16_t getSettingsWriteAmplification();
+#endif
+
   /**
    * @brief получение текущего состояния блинка часов
    *
@@ -463,8 +657,63 @@ public:
    * @return false
    */
   bool getClockEventState();
+
+  /**
+   * @brief подписать callback-функцию на смену секунды, минуты, часа и/или суток
+   *
+   * @param _rollover комбинация флагов CLK_NEW_SECOND, CLK_NEW_MINUTE, CLK_NEW_HOUR, CLK_NEW_DAY
+   * @param _callback вызываемая функция; повторная подписка той же функции меняет ее флаги
+   * @return false, если все ROLLOVER_EVENT_COUNT подписок заняты
+   */
+  bool addRolloverEvent(uint8_t _rollover, clkEventCallback _callback);
+
+  /**
+   * @brief отменить подписку callback-функции на смену секунды, минуты, часа и суток
+   *
+   * @param _callback функция, подписанная методом addRolloverEvent()
+   */
+  void removeRolloverEvent(clkEventCallback _callback);
 #endif
 
+  /**
+   * @brief подписать функцию на события из очереди событий часов
+   *
+   * @param _mask маска типов событий, например CLK_EV_MASK(CLK_EV_BUTTON) | CLK_EV_MASK(CLK_EV_NEW_SECOND)
+   * @param _handler вызываемая функция; повторная подписка той же функции меняет ее маску
+   * @return false, если все EVENT_HANDLER_COUNT подписок заняты
+   */
+  bool addEventHandler(uint8_t _mask, clkEventHandler _handler);
+
+  /**
+   * @brief отменить подписку функции на события
+   *
+   * @param _handler функция, подписанная методом addEventHandler()
+   */
+  void removeEventHandler(clkEventHandler _handler);
+
+  /**
+   * @brief поместить событие в очередь; можно вызывать из обработчика прерывания
+   *
+   * @param _type тип события, для своих событий - CLK_EV_USER1..CLK_EV_USER3
+   * @param _arg аргумент события
+   * @return false, если очередь переполнена и событие отброшено
+   */
+  bool postEvent(clkEventType _type, uint8_t _arg = 0);
+
+  /**
+   * @brief количество событий, отброшенных из-за переполнения очереди
+   *
+   * @return uint16_t
+   */
+  uint16_t getEventDroppedCount();
+
+  /**
+   * @brief наибольшее количество событий, одновременно находившихся в очереди
+   *
+   * @return uint8_t
+   */
+  uint8_t getEventHighWaterMark();
+
   /**
    * @brief сбросить текущее состояние кнопки
    *
@@ -602,6 +851,16 @@ public:
    * @param milliamps максимальный ток, милиампер
    */
   void setMaxPSP(uint8_t volts, uint32_t milliamps);
+
+#if __USE_DUAL_CORE__ && defined(ARDUINO_ARCH_RP2040)
+  /**
+   * @brief вывод на матрицу последнего сформированного кадра; вызывается из
+   *        loop1() скетча при использовании опции USE_SKETCH_LOOP1
+   *
+   * @return false, если новых кадров нет
+   */
+  bool renderTick();
+#endif
 #endif
 
   /**
@@ -611,6 +870,35 @@ public:
    */
   clkDateTime getCurrentDateTime();
 
+  /**
+   * @brief получение количества миллисекунд, прошедших с начала текущей секунды RTC; вместе с getCurrentDateTime() дает единую шкалу времени для анимаций
+   *
+   * @return uint16_t 0..999
+   */
+  uint16_t getCurrentMillis();
+
+  /**
+   * @brief отвечает ли модуль RTC; пока модуль не отвечает, часы идут программно, а на экране это отмечается двоеточием: на семисегментных экранах и LCD оно перестает мигать, на матрицах - начинает
+   *
+   * @return true
+   * @return false
+   */
+  bool isRtcOnline();
+
+  /**
+   * @brief количество неудачных обращений к модулю RTC
+   *
+   * @return uint16_t
+   */
+  uint16_t getRtcErrorCount();
+
+  /**
+   * @brief сколько раз модуль RTC переставал отвечать
+   *
+   * @return uint16_t
+   */
+  uint16_t getRtcOutageCount();
+
   /**
    * @brief установка текущего времени
    *
@@ -632,9 +920,60 @@ public:
   /**
    * @brief установка текущего года
    *
-   * @param _year год для установки (0..99 )
+   * @param _year год для установки полностью (например, 2024) или двумя цифрами (0..99)
    */
-  void setCurrentYear(uint8_t _year);
+  void setCurrentYear(uint16_t _year);
+#endif
+
+#if defined(USE_TIME_ZONE)
+  /**
+   * @brief установка часового пояса; RTC продолжает хранить время UTC, меняется только показываемое местное время
+   *
+   * @param _tz правило в формате POSIX TZ, например, "CET-1CEST,M3.5.0,M10.5.0/3"
+   * @return true, если правило разобрано успешно; иначе используется время UTC
+   */
+  bool setTimeZone(const char *_tz);
+#endif
+
+#if defined(USE_RTC_CALIBRATION)
+  /**
+   * @brief сверка и установка часов по эталонному времени (NTP, GPS, Serial и т.д.); по накопленным сверкам вычисляется и компенсируется дрейф RTC
+   *
+   * @param _utc эталонное время UTC, секунд с 01.01.1970
+   * @param _ms миллисекунды эталонного времени, если известны
+   * @return int32_t расхождение RTC с эталоном на момент сверки, мс; положительное значение - часы спешали
+   */
+  int32_t syncTime(uint32_t _utc, uint16_t _ms = 0);
+
+  /**
+   * @brief получение компенсируемого дрейфа RTC
+   *
+   * @return int32_t сотые доли ppm; положительное значение - без поправки часы спешат
+   */
+  int32_t getRtcDrift();
+
+  /**
+   * @brief получение последней оценки дрейфа RTC по истории сверок
+   *
+   * @return int32_t сотые доли ppm
+   */
+  int32_t getRtcDriftEstimate();
+
+  /**
+   * @brief количество сверок в истории, еще не учтенных в поправке
+   *
+   * @return uint8_t
+   */
+  uint8_t getRtcSyncCount();
+
+  /**
+   * @brief получение данных сверки из истории
+   *
+   * @param _num номер сверки, 0 - самая свежая
+   * @param _sample сюда записываются данные сверки
+   * @return false, если сверки с таким номером нет
+   */
+  bool getRtcSyncRecord(uint8_t _num, clkDriftSample &_sample);
 #endif
 
 #if __USE_TEMP_DATA__
@@ -827,13 +1166,20 @@ public:
 #endif
 
   /**
-   * @brief увеличение списка задач для добавления дополнительных
-   *        пользовательских задач
+   * @brief оставлен для совместимости, ничего не делает; размер списка задач
+   *        теперь задается при компиляции опцией ADDITIONAL_TASK_COUNT в
+   *        файле clockSetting.h; при вызове компилятор выдает предупреждение
    *
-   * @param _add_task количество пользовательских задач, которые будут
-   *                  добавлены в список
    */
-  void setAdditionalTaskCount(uint8_t _add_task);
+  __attribute__((deprecated("the task list size is set at compile time by ADDITIONAL_TASK_COUNT in clockSetting.h")))
+  void setAdditionalTaskCount(uint8_t);
+
+  /**
+   * @brief количество свободных мест в списке задач
+   *
+   * @return uint8_t
+   */
+  uint8_t getFreeTaskCount();
 
   /**
    * @brief добавление пользовательской задачи в список диспетчера задач
@@ -850,6 +1196,25 @@ public:
                               clkTaskManagerCallback _callback,
                               bool isActive = true);
 
+  /**
+   * @brief добавление пользовательской задачи с контекстом в список
+   *        диспетчера задач
+   *
+   * @param _interval интервал срабатывания задачи в милисекундах
+   * @param _callback функция, которая будет вызываться при срабатывании задачи;
+   *                  функция получает указатель _context и не должна возвращать
+   *                  никаких значений
+   * @param _context данные, передаваемые функции задачи, например, указатель
+   *                 на объект для задачи, созданной шаблоном clkTaskMethod
+   * @param isActive активна ли задача с момента добавления или будет запущена потом
+   * @return shHandle, идентификатор задачи в списке в случае успешного добавления
+   *                   ее в список или -1 в случае неудачи
+   */
+  clkHandle addAdditionalTask(unsigned long _interval,
+                              clkTaskCallback _callback,
+                              void *_context,
+                              bool isActive = true);
+
   /**
    * @brief запуск задачи;
    *
@@ -891,6 +1256,137 @@ public:
    * @param _restart если true (по умолчанию), то задача начнет выполняться (или будет перезапущена, если уже была активна) с этого момента;
    */
   void exesTask(clkHandle _handle, bool _restart = true);
+
+  /**
+   * @brief установка поведения задачи при пропуске периодов, например,
+   *        после долгой блокирующей операции;
+   *
+   * @param _handle идентификатор задачи;
+   * @param _policy CLK_OVERRUN_CATCH_UP - выполнить пропущенные срабатывания
+   *                подряд (по умолчанию), CLK_OVERRUN_SKIP - отбросить их,
+   *                сохранив фазу, CLK_OVERRUN_REPHASE - отсчитывать следующий
+   *                период от текущего момента;
+   */
+  void setTaskOverrunPolicy(clkHandle _handle, clkOverrunPolicy _policy);
+
+  /**
+   * @brief количество опозданий задачи на период и более;
+   *
+   * @param _handle идентификатор задачи;
+   * @return uint16_t
+   */
+  uint16_t getTaskOverrunCount(clkHandle _handle);
+
+#if __USE_WATCHDOG__
+  /**
+   * @brief включение контроля задачи сторожевым таймером; опрос RTC, блинк
+   *        и вывод на экран контролируются всегда
+   *
+   * @param _handle идентификатор задачи;
+   * @param _deadline срок, в течение которого задача должна сработать или
+   *                  вызвать taskHeartbeat(), мс; 0 - отключить контроль;
+   * @return false, если все места для контролируемых задач заняты
+   */
+  bool superviseTask(clkHandle _handle, uint16_t _deadline);
+
+  /**
+   * @brief отметка задачи для сторожевого таймера; нужна, если задача долго
+   *        работает внутри одного вызова
+   *
+   * @param _handle идентификатор задачи;
+   */
+  void taskHeartbeat(clkHandle _handle);
+
+  /**
+   * @brief задача, из-за которой произошла предыдущая перезагрузка по
+   *        сторожевому таймеру - зависшая или пропустившая свой срок;
+   *
+   * @return clkHandle CLK_INVALID_HANDLE, если такой задачи не было
+   */
+  clkHandle getWatchdogFailedTask();
+#endif
+
+#if defined(USE_TASK_TRACE)
+  /**
+   * @brief включение и приостановка трассировки задач; например, чтобы
+   *        сохранить в буфере интересующий участок
+   *
+   * @param _state true - срабатывания задач записываются;
+   */
+  void setTaskTraceState(bool _state);
+
+  /**
+   * @brief очистка буфера трассировки задач
+   *
+   */
+  void clearTaskTrace();
+
+  /**
+   * @brief вывод содержимого буфера трассировки задач, например, в Serial;
+   *        для просмотра вывод преобразуется утилитой tools/clktrace2json.py
+   *
+   * @param _out поток для вывода;
+   */
+  void dumpTaskTrace(Print &_out);
+#endif
+
+  /**
+   * @brief добавление пользовательской задачи по расписанию - задачи,
+   *        срабатывающей в заданные моменты времени часов; место под такие
+   *        задачи резервируется опцией ADDITIONAL_CRON_TASK_COUNT
+   *
+   * @param _spec расписание, например, clkCronEvery(15) или clkCronDaily(7, 30, CLK_WEEKDAYS)
+   * @param _callback функция, которая будет вызываться при срабатывании задачи
+   * @param isActive активна ли задача с момента добавления или будет запущена потом
+   * @return clkHandle, идентификатор задачи в списке или -1 в случае неудачи
+   */
+  clkHandle addCronTask(clkCronSpec _spec,
+                        clkTaskManagerCallback _callback,
+                        bool isActive = true);
+
+  /**
+   * @brief добавление пользовательской задачи по расписанию с контекстом
+   *
+   * @param _spec расписание
+   * @param _callback функция, которая будет вызываться при срабатывании задачи
+   * @param _context данные, передаваемые функции задачи
+   * @param isActive активна ли задача с момента добавления или будет запущена потом
+   * @return clkHandle, идентификатор задачи в списке или -1 в случае неудачи
+   */
+  clkHandle addCronTask(clkCronSpec _spec,
+                        clkTaskCallback _callback,
+                        void *_context,
+                        bool isActive = true);
+
+  /**
+   * @brief изменение расписания задачи
+   *
+   * @param _handle идентификатор задачи
+   * @param _spec новое расписание
+   */
+  void setCronTaskSpec(clkHandle _handle, clkCronSpec _spec);
+
+  /**
+   * @brief запуск задачи по расписанию
+   *
+   * @param _handle идентификатор задачи
+   */
+  void startCronTask(clkHandle _handle);
+
+  /**
+   * @brief остановка задачи по расписанию
+   *
+   * @param _handle идентификатор задачи
+   */
+  void stopCronTask(clkHandle _handle);
+
+  /**
+   * @brief время следующего срабатывания задачи по расписанию
+   *
+   * @param _handle идентификатор задачи
+   * @return uint32_t местное время, секунд с 01.01.1970; CLK_CRON_NEVER, если задача не активна
+   */
+  uint32_t getCronTaskNextTime(clkHandle _handle);
 };
 
 // ---- shSimpleClock private -------------------
@@ -905,72 +1401,28 @@ void shSimpleClock::rtc_init()
 #endif
   Wire.begin();
 
+#if defined(RTC_AUTO_DETECT)
+  // определяем, какой из поддерживаемых модулей подключен
+  clkClock.detect();
+#endif
+
+#if defined(USE_TIME_ZONE)
+  clkTZ.setRule(TIME_ZONE_RULE);
+#endif
+
   // если часовой модуль не запущен, запускаем его, для чего нужно установить время
   if (!clkClock.isRunning())
   {
-#if defined(RTC_DS3231)
     // устанавливаем режим 24 часа
     clkClock.setClockMode(false);
-#endif
 
-    clkClock.setCurTime(0, 0, 0);
-    clkClock.setCurDate(1, 1);
-    clkClock.setCurYear(0);
+    clkClock.setCurDateTime(clkDateTime(2000, 1, 1, 0, 0, 0));
   }
-#if !defined(RTC_DS1307)
   clkClock.startRTC();
-#endif
 
   sscRtcNow();
 }
 
-void shSimpleClock::eeprom_validate()
-{
-#if defined(SHOW_SECOND_COLUMN)
-  if (read_eeprom_8(SECOND_COLUMN_ON_OF_DATA_EEPROM_INDEX) > 1)
-  {
-    write_eeprom_8(SECOND_COLUMN_ON_OF_DATA_EEPROM_INDEX, 0);
-  }
-#endif
-
-#if __USE_AUTO_SHOW_DATA__
-  if (read_eeprom_8(INTERVAL_FOR_AUTOSHOWDATA_EEPROM_INDEX) > 7)
-  {
-    write_eeprom_8(INTERVAL_FOR_AUTOSHOWDATA_EEPROM_INDEX, 1);
-  }
-#endif
-
-#if __USE_LIGHT_SENSOR__
-  uint8_t l = read_eeprom_8(LIGHT_THRESHOLD_EEPROM_INDEX);
-  if (l > 9 || l == 0)
-  {
-    write_eeprom_8(LIGHT_THRESHOLD_EEPROM_INDEX, 3);
-  }
-#endif
-
-#if defined(WS2812_MATRIX_DISPLAY)
-  CRGB c;
-  read_eeprom_crgb(COLOR_OF_NUMBER_VALUE_EEPROM_INDEX, c);
-  // если задан черный цвет или не записана ячейка обновления, задать цвет вимволов по умолчанию
-  if ((c.r == 0x00 && c.g == 0x00 && c.b == 0x00) ||
-      read_eeprom_8(COLOR_OF_NUMBER_VALUE_EEPROM_INDEX) != CRGB_UPDATE_DATA)
-  {
-    c = COLOR_OF_NUMBER;
-    write_eeprom_crgb(COLOR_OF_NUMBER_VALUE_EEPROM_INDEX, c);
-  }
-  setColorOfNumber(c);
-
-  read_eeprom_crgb(COLOR_OF_BACKGROUND_VALUE_EEPROM_INDEX, c);
-  // если не записана ячейка обновления, задать цвет фона по умолчанию
-  if (read_eeprom_8(COLOR_OF_BACKGROUND_VALUE_EEPROM_INDEX) != CRGB_UPDATE_DATA)
-  {
-    c = COLOR_OF_BACKGROUND;
-    write_eeprom_crgb(COLOR_OF_BACKGROUND_VALUE_EEPROM_INDEX, COLOR_OF_BACKGROUND);
-  }
-  setColorOfBackground(c);
-#endif
-}
-
 void shSimpleClock::sensor_init()
 {
 #if defined(USE_DS18B20)
@@ -984,43 +1436,57 @@ void shSimpleClock::sensor_init()
   pinMode((uint8_t)LIGHT_SENSOR_PIN, INPUT_ANALOG);
 #endif
   sscGetLightThresholdStep(BIT_DEPTH);
-#endif
-  // проверить корректность заданных уровней яркости
-  uint8_t x = read_eeprom_8(MAX_BRIGHTNESS_VALUE_EEPROM_INDEX);
-#if defined(MAX72XX_7SEGMENT_DISPLAY) || defined(MAX72XX_MATRIX_DISPLAY)
-  x = (x > 15) ? 8 : x;
-#elif defined(WS2812_MATRIX_DISPLAY)
-  x = ((x > 25) || (x == 0)) ? 15 : x;
 #else
-  x = ((x > 7) || (x == 0)) ? 7 : x;
+  // уровни яркости проверяются по схеме настроек при их загрузке (settings_check())
+  clkDisplay.setBrightness(read_eeprom_8(MAX_BRIGHTNESS_VALUE_EEPROM_INDEX));
 #endif
-  write_eeprom_8(MAX_BRIGHTNESS_VALUE_EEPROM_INDEX, x);
-#if __USE_LIGHT_SENSOR__
-  uint8_t y = read_eeprom_8(LIGHT_THRESHOLD_EEPROM_INDEX);
-  if ((y > 9) || (y == 0))
+#endif
+}
+
+#if __USE_DUAL_CORE__
+#if defined(ARDUINO_ARCH_ESP32)
+// задача вывода кадров на матрицу; работает на ядре, свободном от loop()
+void sscRenderTask(void *)
+{
+  for (;;)
   {
-    write_eeprom_8(LIGHT_THRESHOLD_EEPROM_INDEX, 3);
+    if (!clkDisplay.render())
+    {
+      vTaskDelay(1);
+    }
   }
+}
+#elif defined(ARDUINO_ARCH_RP2040) && !defined(USE_SKETCH_LOOP1)
+// вывод кадров на матрицу выполняет второе ядро; если второе ядро нужно и
+// скетчу, задается опция USE_SKETCH_LOOP1 - тогда setup1() и loop1()
+// определяет скетч, а кадры выводятся вызовом renderTick() из его loop1()
+void setup1() {}
 
-  x = read_eeprom_8(MIN_BRIGHTNESS_VALUE_EEPROM_INDEX);
-#if defined(MAX72XX_7SEGMENT_DISPLAY) || defined(MAX72XX_MATRIX_DISPLAY)
-  x = (x > 15) ? 0 : x;
-#elif defined(WS2812_MATRIX_DISPLAY)
-  x = ((x > 25) || (x == 0)) ? 1 : x;
-#else
-  x = ((x > 7) || (x == 0)) ? 1 : x;
-#endif
-  write_eeprom_8(MIN_BRIGHTNESS_VALUE_EEPROM_INDEX, x);
-#else
-  clkDisplay.setBrightness(read_eeprom_8(MAX_BRIGHTNESS_VALUE_EEPROM_INDEX));
+void loop1()
+{
+  if (!clkDisplay.render())
+  {
+    delay(1);
+  }
+}
 #endif
 #endif
-}
 
 void shSimpleClock::display_init()
 {
 #if defined(WS2812_MATRIX_DISPLAY)
   clkDisplay.init();
+#if __USE_DUAL_CORE__ && defined(ARDUINO_ARCH_ESP32)
+  // задача вывода запускается на ядре, на котором не работает loop()
+  xTaskCreatePinnedToCore(sscRenderTask, "clk_render", 4096, nullptr, 1, nullptr,
+                          (ARDUINO_RUNNING_CORE == 0) ? 1 : 0);
+#endif
+  // цвета символов и фона из настроек
+  CRGB c;
+  read_eeprom_crgb(COLOR_OF_NUMBER_VALUE_EEPROM_INDEX, c);
+  clkDisplay.setColorOfNumber(c);
+  read_eeprom_crgb(COLOR_OF_BACKGROUND_VALUE_EEPROM_INDEX, c);
+  clkDisplay.setColorOfBackground(c);
 #elif defined(MAX72XX_MATRIX_DISPLAY) || defined(MAX72XX_7SEGMENT_DISPLAY)
   clkDisplay.init();
   clkDisplay.shutdownAllDevices(false);
@@ -1034,7 +1500,10 @@ void shSimpleClock::display_init()
 
 // выставить яркость в минимум, чтобы при включении не сверкало максимальной яркостью
 #if defined(WS2812_MATRIX_DISPLAY)
+#if !__USE_DUAL_CORE__
+  // при выводе на отдельном ядре яркость передается вместе с каждым кадром
   FastLED.setBrightness(0);
+#endif
 #elif defined(MAX72XX_MATRIX_DISPLAY) || defined(MAX72XX_7SEGMENT_DISPLAY)
   clkDisplay.setBrightness(0);
 #elif defined(TM1637_DISPLAY)
@@ -1044,27 +1513,6 @@ void shSimpleClock::display_init()
 
 void shSimpleClock::task_list_init()
 {
-  uint8_t task_count = 5; // базовое количество задач
-#if defined(USE_ALARM)
-  task_count += 2;
-#endif
-#if __USE_AUTO_SHOW_DATA__
-  task_count++;
-#endif
-#if __USE_TEMP_DATA__ && defined(USE_DS18B20)
-  task_count++;
-#endif
-#if __USE_LIGHT_SENSOR__
-  task_count++;
-#endif
-#if __USE_OTHER_SETTING__
-  task_count++;
-#endif
-#if defined(USE_TICKER_FOR_DATA)
-  task_count++;
-#endif
-  clkTasks.init(task_count);
-
   clkTasks.rtc_guard = clkTasks.addTask(50ul, sscRtcNow);
   clkTasks.blink_timer = clkTasks.addTask(50ul, sscBlink);
   clkTasks.return_to_default_mode = clkTasks.addTask(AUTO_EXIT_TIMEOUT * 1000ul,
@@ -1072,14 +1520,14 @@ void shSimpleClock::task_list_init()
                                                      false);
   clkTasks.set_time_mode = clkTasks.addTask(50ul, sscShowTimeSetting, false);
 #if __USE_TEMP_DATA__ && defined(USE_DS18B20)
-  clkTasks.ds18b20_guard = clkTasks.addTask(3000ul, sscCheckDS18b20);
+  clkTasks.ds18b20_guard = clkTasks.addTask(250ul, sscCheckDS18b20, &ssc_ds18b20_state);
 #endif
 #if __USE_AUTO_SHOW_DATA__
-  clkTasks.auto_show_mode = clkTasks.addTask(100ul, sscAutoShowData, false);
+  clkTasks.auto_show_mode = clkTasks.addTask(100ul, sscAutoShowData, &ssc_auto_show_state, false);
 #endif
 #if defined(USE_ALARM)
   clkTasks.alarm_guard = clkTasks.addTask(200ul, sscCheckAlarm);
-  clkTasks.alarm_buzzer = clkTasks.addTask(50ul, sscRunAlarmBuzzer, false);
+  clkTasks.alarm_buzzer = clkTasks.addTask(SSC_BUZZER_INTERVAL, sscRunAlarmBuzzer, &ssc_buzzer_state, false);
 #endif
   clkTasks.display_guard = clkTasks.addTask(50ul, sscShowDisplay);
 #if __USE_LIGHT_SENSOR__
@@ -1091,7 +1539,64 @@ void shSimpleClock::task_list_init()
   clkTasks.other_setting_mode = clkTasks.addTask(50ul, sscShowOtherSetting, false);
 #endif
 #if defined(USE_TICKER_FOR_DATA)
-  clkTasks.ticker = clkTasks.addTask(1000ul / TICKER_SPEED, sscRunTicker, false);
+  clkTasks.ticker = clkTasks.addTask(1000ul / TICKER_SPEED, sscRunTicker, &ssc_ticker_state, false);
+#endif
+#if defined(USE_DIGIT_ANIMATION)
+  clkTasks.digit_animation = clkTasks.addTask(1000ul / DIGIT_ANIMATION_SPEED,
+                                              sscRunDigitAnimation,
+                                              false);
+#endif
+#if __USE_EEPROM_WRITE_BEHIND__
+  clkTasks.eeprom_guard = clkTasks.addTask(500ul, eeprom_tick);
+#endif
+
+  // опросы и вывод на экран после задержки не наверстываются - повторные
+  // срабатывания подряд дали бы только лишнюю нагрузку и мерцание экрана;
+  // анимация после задержки продолжается от текущего момента без рывков
+  clkTasks.setOverrunPolicy(clkTasks.rtc_guard, CLK_OVERRUN_SKIP);
+  clkTasks.setOverrunPolicy(clkTasks.blink_timer, CLK_OVERRUN_SKIP);
+  clkTasks.setOverrunPolicy(clkTasks.set_time_mode, CLK_OVERRUN_SKIP);
+  clkTasks.setOverrunPolicy(clkTasks.display_guard, CLK_OVERRUN_SKIP);
+#if __USE_TEMP_DATA__ && defined(USE_DS18B20)
+  clkTasks.setOverrunPolicy(clkTasks.ds18b20_guard, CLK_OVERRUN_SKIP);
+#endif
+#if __USE_AUTO_SHOW_DATA__
+  clkTasks.setOverrunPolicy(clkTasks.auto_show_mode, CLK_OVERRUN_SKIP);
+#endif
+#if defined(USE_ALARM)
+  clkTasks.setOverrunPolicy(clkTasks.alarm_guard, CLK_OVERRUN_SKIP);
+#endif
+#if __USE_LIGHT_SENSOR__
+  clkTasks.setOverrunPolicy(clkTasks.light_sensor_guard, CLK_OVERRUN_SKIP);
+#endif
+#if __USE_OTHER_SETTING__
+  clkTasks.setOverrunPolicy(clkTasks.other_setting_mode, CLK_OVERRUN_SKIP);
+#endif
+#if defined(USE_TICKER_FOR_DATA)
+  clkTasks.setOverrunPolicy(clkTasks.ticker, CLK_OVERRUN_REPHASE);
+#endif
+#if defined(USE_DIGIT_ANIMATION)
+  clkTasks.setOverrunPolicy(clkTasks.digit_animation, CLK_OVERRUN_REPHASE);
+#endif
+#if __USE_EEPROM_WRITE_BEHIND__
+  clkTasks.setOverrunPolicy(clkTasks.eeprom_guard, CLK_OVERRUN_SKIP);
+#endif
+
+  // задачи по расписанию; время срабатывания задается по текущим настройкам
+#if defined(USE_ALARM)
+  clkCron.alarm_trigger = clkCron.addTask(clkCronDaily(0, 0, 0), sscAlarmTrigger);
+  sscSetAlarmSchedule();
+#endif
+#if __USE_AUTO_SHOW_DATA__
+  clkCron.auto_show_trigger = clkCron.addTask(clkCronEvery(0, 0), sscStartAutoShow);
+  sscSetAutoShowSchedule();
+#endif
+
+#if __USE_WATCHDOG__
+  // без этих задач часы фактически стоят; сторожевой таймер запустится при первом вызове tick()
+  clkTasks.superviseTask(clkTasks.rtc_guard, WATCHDOG_TASK_DEADLINE);
+  clkTasks.superviseTask(clkTasks.display_guard, WATCHDOG_TASK_DEADLINE);
+  clkTasks.superviseTask(clkTasks.blink_timer, WATCHDOG_TASK_DEADLINE);
 #endif
 }
 
@@ -1127,6 +1632,10 @@ void shSimpleClock::init()
   EEPROM.begin(_eeprom_size);
 #endif
 
+  // ==== настройки ==================================
+  // загрузка и проверка по схеме настроек
+  settings_load();
+
 #if defined(USE_ALARM)
   // ==== будильник ==================================
   clkAlarm.init();
@@ -1135,9 +1644,6 @@ void shSimpleClock::init()
   // ==== кнопки =====================================
   clkButtons.init();
 
-  // ==== валидация EEPROM ===========================
-  eeprom_validate();
-
   // ==== датчики ====================================
   sensor_init();
 
@@ -1158,15 +1664,37 @@ void shSimpleClock::tick()
     last_tick = millis();
     sscCheckButton();
     clkTasks.tick();
-    sscSetDisplayMode();
+    if (ssc_display_mode_changed)
+    {
+      ssc_display_mode_changed = false;
+      sscSetDisplayMode();
+    }
+    clkEvents.dispatch();
   }
 }
 
+void shSimpleClock::flushSettings()
+{
+  settings_flush();
+}
+
+#if __USE_SETTINGS_LOG__
+uint32_t shSimpleClock::getSettingsCompactionCount() { return (clkSetLog.getCompactionCount()); }
+
+uint32_t shSimpleClock::getSettingsBytesWritten() { return (clkSetLog.getPhysicalBytes()); }
+
+uint16_t shSimpleClock::getSettingsWriteAmplification()
+{
+  uint32_t x = clkSetLog.getLogicalBytes();
+  return ((x) ? clkSetLog.getPhysicalBytes() * 100 / x : 0);
+}
+#endif
+
 bool shSimpleClock::getBlink() { return sscBlinkFlag; }
 
 clkDisplayMode shSimpleClock::getDisplayMode() { return ssc_display_mode; }
 
-void shSimpleClock::setDisplayMode(clkDisplayMode _mode) { ssc_display_mode = _mode; }
+void shSimpleClock::setDisplayMode(clkDisplayMode _mode) { sscChangeDisplayMode(_mode); }
 
 #if defined(LCD_I2C_DISPLAY)
 void shSimpleClock::setBacklightState(bool _state)
@@ -1184,18 +1712,47 @@ void shSimpleClock::printTextForScreen(uint8_t _col, uint8_t _line, const char *
 }
 #endif
 
-#if defined USE_CLOCK_EVENT
-void shSimpleClock::setClockEvent(uint16_t _interval,
-                                  clkEventCallback _callback,
-                                  bool _active)
+#if defined USE_CLOCK_EVENT
+void shSimpleClock::setClockEvent(uint16_t _interval,
+                                  clkEventCallback _callback,
+                                  bool _active)
+{
+  sscClockEvent.init(_interval, _callback, _active);
+}
+
+void shSimpleClock::setClockEventState(bool _state) { sscClockEvent.setState(_state); }
+
+bool shSimpleClock::getClockEventState() { return sscClockEvent.getState(); }
+
+bool shSimpleClock::addRolloverEvent(uint8_t _rollover, clkEventCallback _callback)
+{
+  return (sscRolloverEvent.add(_rollover, _callback));
+}
+
+void shSimpleClock::removeRolloverEvent(clkEventCallback _callback)
+{
+  sscRolloverEvent.remove(_callback);
+}
+#endif
+
+bool shSimpleClock::addEventHandler(uint8_t _mask, clkEventHandler _handler)
+{
+  return (clkEvents.addHandler(_mask, _handler));
+}
+
+void shSimpleClock::removeEventHandler(clkEventHandler _handler)
+{
+  clkEvents.removeHandler(_handler);
+}
+
+bool shSimpleClock::postEvent(clkEventType _type, uint8_t _arg)
 {
-  sscClockEvent.init(_interval, _callback, _active);
+  return (clkEvents.post(_type, _arg));
 }
 
-void shSimpleClock::setClockEventState(bool _state) { sscClockEvent.setState(_state); }
+uint16_t shSimpleClock::getEventDroppedCount() { return (clkEvents.getDroppedCount()); }
 
-bool shSimpleClock::getClockEventState() { return sscClockEvent.getState(); }
-#endif
+uint8_t shSimpleClock::getEventHighWaterMark() { return (clkEvents.getHighWaterMark()); }
 
 void shSimpleClock::resetButtonState(clkButtonType _btn)
 {
@@ -1300,6 +1857,10 @@ void shSimpleClock::setMaxPSP(uint8_t volts, uint32_t milliamps)
 {
   clkDisplay.setMaxPSP(volts, milliamps);
 }
+
+#if __USE_DUAL_CORE__ && defined(ARDUINO_ARCH_RP2040)
+bool shSimpleClock::renderTick() { return (clkDisplay.render()); }
+#endif
 #endif
 
 clkDateTime shSimpleClock::getCurrentDateTime()
@@ -1307,12 +1868,21 @@ clkDateTime shSimpleClock::getCurrentDateTime()
   return (clkClock.getCurTime());
 }
 
+uint16_t shSimpleClock::getCurrentMillis()
+{
+  return (clkClock.getCurMillis());
+}
+
+bool shSimpleClock::isRtcOnline() { return (clkClock.isOnline()); }
+
+uint16_t shSimpleClock::getRtcErrorCount() { return (clkClock.getErrorCount()); }
+
+uint16_t shSimpleClock::getRtcOutageCount() { return (clkClock.getOutageCount()); }
+
 void shSimpleClock::setCurrentTime(uint8_t _hour, uint8_t _minute, uint8_t _second)
 {
-#if defined(RTC_DS3231)
   // устанавливаем режим 24 часа
   clkClock.setClockMode(false);
-#endif
   clkClock.setCurTime(_hour, _minute, _second);
 }
 
@@ -1322,12 +1892,39 @@ void shSimpleClock::setCurrentDate(uint8_t _date, uint8_t _month)
   clkClock.setCurDate(_date, _month);
 }
 
-void shSimpleClock::setCurrentYear(uint8_t _year)
+void shSimpleClock::setCurrentYear(uint16_t _year)
 {
   clkClock.setCurYear(_year);
 }
 #endif
 
+#if defined(USE_TIME_ZONE)
+bool shSimpleClock::setTimeZone(const char *_tz)
+{
+  bool result = clkTZ.setRule(_tz);
+  clkClock.now();
+  return (result);
+}
+#endif
+
+#if defined(USE_RTC_CALIBRATION)
+int32_t shSimpleClock::syncTime(uint32_t _utc, uint16_t _ms)
+{
+  return (clkRtcCal.addReference(_utc, _ms));
+}
+
+int32_t shSimpleClock::getRtcDrift() { return (clkRtcCal.getDrift()); }
+
+int32_t shSimpleClock::getRtcDriftEstimate() { return (clkRtcCal.getEstimate()); }
+
+uint8_t shSimpleClock::getRtcSyncCount() { return (clkRtcCal.getHistoryCount()); }
+
+bool shSimpleClock::getRtcSyncRecord(uint8_t _num, clkDriftSample &_sample)
+{
+  return (clkRtcCal.getHistory(_num, _sample));
+}
+#endif
+
 #if __USE_TEMP_DATA__
 int8_t shSimpleClock::getTemperature()
 {
@@ -1350,11 +1947,16 @@ bool shSimpleClock::getAlarmEventState() { sscAlarmEvent.getState(); }
 
 uint16_t shSimpleClock::getAlarmPoint() { return (clkAlarm.getAlarmPoint()); }
 
-void shSimpleClock::setAlarmPoint(uint16_t _point) { clkAlarm.setAlarmPoint(_point); }
+void shSimpleClock::setAlarmPoint(uint16_t _point)
+{
+  clkAlarm.setAlarmPoint(_point);
+  sscSetAlarmSchedule();
+}
 
 void shSimpleClock::setAlarmPoint(uint8_t _hour, uint8_t _minute)
 {
   clkAlarm.setAlarmPoint(_hour * 60 + _minute);
+  sscSetAlarmSchedule();
 }
 
 bool shSimpleClock::getOnOffAlarm() { return (clkAlarm.getOnOffAlarm()); }
@@ -1381,9 +1983,6 @@ uint8_t shSimpleClock::getBrightnessMax()
 void shSimpleClock::setBrightnessMax(uint8_t _br)
 {
   write_eeprom_8(MAX_BRIGHTNESS_VALUE_EEPROM_INDEX, _br);
-#if defined(WS2812_MATRIX_DISPLAY)
-  _br *= 10;
-#endif
   clkDisplay.setBrightness(_br);
 }
 
@@ -1396,9 +1995,6 @@ uint8_t shSimpleClock::getBrightnessMin()
 void shSimpleClock::setBrightnessMin(uint8_t _br)
 {
   write_eeprom_8(MIN_BRIGHTNESS_VALUE_EEPROM_INDEX, _br);
-#if defined(WS2812_MATRIX_DISPLAY)
-  _br *= 10;
-#endif
   clkDisplay.setBrightness(_br);
 }
 #endif
@@ -1437,6 +2033,7 @@ void shSimpleClock::setIntervalForAutoShowData(uint8_t _index)
 {
   _index = (_index > 7) ? 1 : _index;
   write_eeprom_8(INTERVAL_FOR_AUTOSHOWDATA_EEPROM_INDEX, _index);
+  sscSetAutoShowSchedule();
 }
 
 uint8_t shSimpleClock::getIntervalForAutoShowData()
@@ -1459,9 +2056,11 @@ bool shSimpleClock::getSecondColumnState()
 
 #endif
 
-void shSimpleClock::setAdditionalTaskCount(uint8_t _add_task)
+void shSimpleClock::setAdditionalTaskCount(uint8_t) {}
+
+uint8_t shSimpleClock::getFreeTaskCount()
 {
-  clkTasks.setAddTaskCount(_add_task);
+  return (clkTasks.getFreeCount());
 }
 
 clkHandle shSimpleClock::addAdditionalTask(unsigned long _interval,
@@ -1471,6 +2070,14 @@ clkHandle shSimpleClock::addAdditionalTask(unsigned long _interval,
   return clkTasks.addTask(_interval, _callback, isActive);
 }
 
+clkHandle shSimpleClock::addAdditionalTask(unsigned long _interval,
+                                           clkTaskCallback _callback,
+                                           void *_context,
+                                           bool isActive)
+{
+  return clkTasks.addTask(_interval, _callback, _context, isActive);
+}
+
 void shSimpleClock::startTask(clkHandle _handle)
 {
   clkTasks.startTask(_handle);
@@ -1498,12 +2105,151 @@ void shSimpleClock::exesTask(clkHandle _handle, bool _restart)
   clkTasks.taskExes(_handle, _restart);
 }
 
+void shSimpleClock::setTaskOverrunPolicy(clkHandle _handle, clkOverrunPolicy _policy)
+{
+  clkTasks.setOverrunPolicy(_handle, _policy);
+}
+
+uint16_t shSimpleClock::getTaskOverrunCount(clkHandle _handle)
+{
+  return (clkTasks.getOverrunCount(_handle));
+}
+
+#if __USE_WATCHDOG__
+bool shSimpleClock::superviseTask(clkHandle _handle, uint16_t _deadline)
+{
+  return (clkTasks.superviseTask(_handle, _deadline));
+}
+
+void shSimpleClock::taskHeartbeat(clkHandle _handle) { clkTasks.heartbeat(_handle); }
+
+clkHandle shSimpleClock::getWatchdogFailedTask() { return (clkTasks.getLastFailedTask()); }
+#endif
+
+#if defined(USE_TASK_TRACE)
+void shSimpleClock::setTaskTraceState(bool _state) { clkTrace.setActive(_state); }
+
+void shSimpleClock::clearTaskTrace() { clkTrace.clear(); }
+
+void sscPrintTraceName(Print &_out, clkHandle _handle, const __FlashStringHelper *_name)
+{
+  _out.print('@');
+  _out.print(_handle);
+  _out.print(' ');
+  _out.println(_name);
+}
+
+void shSimpleClock::dumpTaskTrace(Print &_out)
+{
+  // на время вывода запись приостанавливается
+  bool state = clkTrace.isActive();
+  clkTrace.setActive(false);
+
+  _out.println(F("#clktrace 1"));
+  _out.print(F("#lost "));
+  _out.println(clkTrace.getLostCount());
+
+  sscPrintTraceName(_out, clkTasks.rtc_guard, F("sscRtcNow"));
+  sscPrintTraceName(_out, clkTasks.blink_timer, F("sscBlink"));
+  sscPrintTraceName(_out, clkTasks.return_to_default_mode, F("sscReturnToDefMode"));
+  sscPrintTraceName(_out, clkTasks.set_time_mode, F("sscShowTimeSetting"));
+  sscPrintTraceName(_out, clkTasks.display_guard, F("sscShowDisplay"));
+#if defined(USE_ALARM)
+  sscPrintTraceName(_out, clkTasks.alarm_guard, F("sscCheckAlarm"));
+  sscPrintTraceName(_out, clkTasks.alarm_buzzer, F("sscRunAlarmBuzzer"));
+#endif
+#if __USE_AUTO_SHOW_DATA__
+  sscPrintTraceName(_out, clkTasks.auto_show_mode, F("sscAutoShowData"));
+#endif
+#if __USE_TEMP_DATA__ && defined(USE_DS18B20)
+  sscPrintTraceName(_out, clkTasks.ds18b20_guard, F("sscCheckDS18b20"));
+#endif
+#if __USE_LIGHT_SENSOR__
+  sscPrintTraceName(_out, clkTasks.light_sensor_guard, F("sscSetBrightness"));
+#endif
+#if __USE_OTHER_SETTING__
+  sscPrintTraceName(_out, clkTasks.other_setting_mode, F("sscShowOtherSetting"));
+#endif
+#if defined(USE_TICKER_FOR_DATA)
+  sscPrintTraceName(_out, clkTasks.ticker, F("sscRunTicker"));
+#endif
+#if defined(USE_DIGIT_ANIMATION)
+  sscPrintTraceName(_out, clkTasks.digit_animation, F("sscRunDigitAnimation"));
+#endif
+#if __USE_EEPROM_WRITE_BEHIND__
+  sscPrintTraceName(_out, clkTasks.eeprom_guard, F("eeprom_tick"));
+#endif
+
+  for (uint8_t i = 0; i < clkTrace.getCount(); i++)
+  {
+    const clkTraceRecord &r = clkTrace.get(i);
+    _out.print(r.task);
+    _out.print(' ');
+    _out.print(r.start);
+    _out.print(' ');
+    _out.println(r.end);
+  }
+  _out.println(F("#end"));
+
+  clkTrace.setActive(state);
+}
+#endif
+
+clkHandle shSimpleClock::addCronTask(clkCronSpec _spec,
+                                     clkTaskManagerCallback _callback,
+                                     bool isActive)
+{
+  return clkCron.addTask(_spec, _callback, isActive);
+}
+
+clkHandle shSimpleClock::addCronTask(clkCronSpec _spec,
+                                     clkTaskCallback _callback,
+                                     void *_context,
+                                     bool isActive)
+{
+  return clkCron.addTask(_spec, _callback, _context, isActive);
+}
+
+void shSimpleClock::setCronTaskSpec(clkHandle _handle, clkCronSpec _spec)
+{
+  clkCron.setTaskSpec(_handle, _spec);
+}
+
+void shSimpleClock::startCronTask(clkHandle _handle) { clkCron.startTask(_handle); }
+
+void shSimpleClock::stopCronTask(clkHandle _handle) { clkCron.stopTask(_handle); }
+
+uint32_t shSimpleClock::getCronTaskNextTime(clkHandle _handle)
+{
+  return (clkCron.getNextTime(_handle));
+}
+
 // ==== end shSimpleClock ============================
 
 void sscRtcNow()
 {
 
   clkClock.now();
+#if __USE_RTC_SOFT_CALIBRATION__
+  clkRtcCal.tick();
+#endif
+  uint8_t rollover = clkClock.getRollover();
+#if defined USE_CLOCK_EVENT
+  if (rollover & CLK_NEW_SECOND)
+  {
+    sscClockEvent.run();
+  }
+  if (rollover)
+  {
+    sscRolloverEvent.run(rollover);
+  }
+#endif
+  if (rollover & CLK_NEW_SECOND)
+  {
+    clkCron.tick(clkClock.getCurTime().unixtime(), clkClock.getCurUtc());
+    clkEvents.post(CLK_EV_NEW_SECOND, clkClock.getCurTime().second());
+  }
+
   if (ssc_display_mode == DISPLAY_MODE_SHOW_TIME)
   {
 #if defined(USE_TICKER_FOR_DATA)
@@ -1514,25 +2260,6 @@ void sscRtcNow()
     }
 #endif
 
-#if __USE_AUTO_SHOW_DATA__
-    static bool flag = false;
-
-    if (clkClock.getCurTime().second() > 0)
-    {
-      flag = false;
-    }
-
-    uint8_t x = read_eeprom_8(INTERVAL_FOR_AUTOSHOWDATA_EEPROM_INDEX);
-    if (((sscGetPeriodForAutoShow(x) > 0) &&
-         (clkClock.getCurTime().minute() % sscGetPeriodForAutoShow(x) == 0)) &&
-        (clkClock.getCurTime().second() == 0) &&
-        !flag)
-    {
-      flag = true;
-      ssc_display_mode = DISPLAY_AUTO_SHOW_DATA;
-    }
-    else
-#endif
     {
 #if __USE_MATRIX_DISPLAY__
       sscShowTimeData(clkClock.getCurTime().hour(),
@@ -1547,31 +2274,26 @@ void sscRtcNow()
 #endif
 
 #else
+      // пока RTC не отвечает, двоеточие не мигает
       sscShowTime(clkClock.getCurTime().hour(),
                   clkClock.getCurTime().minute(),
-                  sscBlinkFlag);
+                  sscBlinkFlag || !clkClock.isOnline());
 #endif
     }
   }
+#if defined(USE_DIGIT_ANIMATION)
+  else
+  {
+    // вне режима показа времени запоминать нечего; анимация сработает только при смене цифр на экране
+    sscDigitAnimation.reset();
+  }
+#endif
 }
 
 void sscBlink()
 {
-  static uint8_t cur_sec = clkClock.getCurTime().second();
-  static unsigned long tmr = 0;
-  if (cur_sec != clkClock.getCurTime().second())
-  {
-#if defined USE_CLOCK_EVENT
-    sscClockEvent.run();
-#endif
-    cur_sec = clkClock.getCurTime().second();
-    sscBlinkFlag = false;
-    tmr = millis();
-  }
-  else if (!sscBlinkFlag && millis() - tmr >= 500)
-  {
-    sscBlinkFlag = true;
-  }
+  // фаза блинка привязана к началу секунды RTC: первая половина секунды - false, вторая - true
+  sscBlinkFlag = clkClock.getCurMillis() >= 500;
 }
 
 void sscReturnToDefMode()
@@ -1623,7 +2345,7 @@ void sscReturnToDefMode()
   case DISPLAY_AUTO_SHOW_DATA:
     clkTasks.stopTask(clkTasks.auto_show_mode);
 #endif
-    ssc_display_mode = DISPLAY_MODE_SHOW_TIME;
+    sscChangeDisplayMode(DISPLAY_MODE_SHOW_TIME);
     break;
   default:
     break;
@@ -1636,6 +2358,7 @@ void sscReturnToDefMode()
   }
 #endif
   clkTasks.stopTask(clkTasks.return_to_default_mode);
+  settings_flush();
 }
 
 void sscShowTimeData(int8_t hour, int8_t minute)
@@ -1679,12 +2402,17 @@ void sscShowTimeData(int8_t hour, int8_t minute)
 #endif
 #if __USE_MATRIX_DISPLAY__
   bool toDate = false;
+  if (ssc_display_mode == DISPLAY_MODE_SHOW_TIME && !clkClock.isOnline())
+  {
+    // пока RTC не отвечает, двоеточие мигает
+    toColon = sscBlinkFlag;
+  }
 #if defined(USE_CALENDAR)
   toDate = (ssc_display_mode >= DISPLAY_MODE_SET_DAY &&
             ssc_display_mode <= DISPLAY_MODE_SET_YEAR);
   if (ssc_display_mode == DISPLAY_MODE_SET_YEAR)
   {
-    sscSetYearString(1, minute);
+    sscSetYearString(1, hour, minute);
   }
   else
 #endif
@@ -1700,6 +2428,27 @@ void sscShowTimeData(int8_t hour, int8_t minute)
     }
 #endif
     sscSetTimeString(x, hour, minute, toColon, toDate);
+#if __USE_DATE_WITH_TIME__
+    // если позволяет размер матрицы, вместе со временем вывести число и месяц
+    if (ssc_display_mode == DISPLAY_MODE_SHOW_TIME)
+    {
+      // при включенном секундном столбике дата, как и время, смещается влево,
+      // освобождая крайний правый столбец
+      sscSetTimeString(MATRIX_DATE_OFFSET + x,
+                       clkClock.getCurTime().day(),
+                       clkClock.getCurTime().month(),
+                       true,
+                       true,
+                       false,
+                       MATRIX_DATE_LINE);
+    }
+#endif
+#if defined(USE_DIGIT_ANIMATION)
+    if (ssc_display_mode == DISPLAY_MODE_SHOW_TIME)
+    {
+      sscCheckDigitAnimation(x, hour, minute);
+    }
+#endif
   }
 #else
   sscShowTime(hour, minute, toColon);
@@ -1724,7 +2473,7 @@ void sscShowSecondColumn(int8_t second)
       col_sec &= ~(1 << 7);
     }
   }
-  clkDisplay.setColumn(31, col_sec);
+  sscSetColumn(MATRIX_SECOND_COLUMN, col_sec);
 }
 #endif
 
@@ -1760,6 +2509,10 @@ void sscStopSetting(clkHandle task)
   clkTasks.stopTask(task);
   clkTasks.stopTask(clkTasks.return_to_default_mode);
   sscClearButtonFlag();
+  // если режим экрана остается режимом настроек, задача настроек будет запущена заново
+  ssc_display_mode_changed = true;
+  // при выходе из режима настроек сразу сохранить изменения и контрольную сумму
+  settings_flush();
 }
 
 // ==== sscShowTimeSetting ===========================
@@ -1841,10 +2594,8 @@ void _checkBtnSetForTmSet(uint8_t &curHour,
       {
       case DISPLAY_MODE_SET_HOUR:
       case DISPLAY_MODE_SET_MINUTE:
-#if defined(RTC_DS3231)
         // устанавливаем режим 24 часа
         clkClock.setClockMode(false);
-#endif
         clkClock.setCurTime(curHour, curMinute, 0);
         sscRtcNow();
         break;
@@ -1855,7 +2606,7 @@ void _checkBtnSetForTmSet(uint8_t &curHour,
         sscRtcNow();
         break;
       case DISPLAY_MODE_SET_YEAR:
-        clkClock.setCurYear(curMinute);
+        clkClock.setCurYear(curHour * 100 + curMinute);
         sscRtcNow();
         break;
 #endif
@@ -1863,6 +2614,7 @@ void _checkBtnSetForTmSet(uint8_t &curHour,
       case DISPLAY_MODE_SET_ALARM_HOUR:
       case DISPLAY_MODE_SET_ALARM_MINUTE:
         clkAlarm.setAlarmPoint(curHour * 60 + curMinute);
+        sscSetAlarmSchedule();
         break;
       case DISPLAY_MODE_ALARM_ON_OFF:
         clkAlarm.setOnOffAlarm((bool)curHour);
@@ -1896,24 +2648,24 @@ void _checkBtnSetForTmSet(uint8_t &curHour,
 #if defined(USE_ALARM)
       case DISPLAY_MODE_SET_ALARM_HOUR:
 #endif
-        ssc_display_mode = clkDisplayMode(uint8_t(ssc_display_mode + 1));
+        sscChangeDisplayMode(clkDisplayMode(uint8_t(ssc_display_mode + 1)));
         sscStopSetting(clkTasks.set_time_mode);
         break;
 #if defined(USE_ALARM)
       case DISPLAY_MODE_ALARM_ON_OFF:
-        ssc_display_mode = (curHour) ? DISPLAY_MODE_SET_ALARM_HOUR
-                                     : DISPLAY_MODE_SHOW_TIME;
+        sscChangeDisplayMode((curHour) ? DISPLAY_MODE_SET_ALARM_HOUR
+                                       : DISPLAY_MODE_SHOW_TIME);
         sscStopSetting(clkTasks.set_time_mode);
         break;
 #endif
 #if defined(USE_TICKER_FOR_DATA)
       case DISPLAY_MODE_SET_TICKER_ON_OFF:
 #if __USE_AUTO_SHOW_DATA__
-        ssc_display_mode = DISPLAY_MODE_SET_AUTO_SHOW_PERIOD;
+        sscChangeDisplayMode(DISPLAY_MODE_SET_AUTO_SHOW_PERIOD);
 #elif defined(WS2812_MATRIX_DISPLAY)
-        ssc_display_mode = DISPLAY_MODE_SET_COLOR_OF_NUMBER;
+        sscChangeDisplayMode(DISPLAY_MODE_SET_COLOR_OF_NUMBER);
 #else
-        ssc_display_mode = DISPLAY_MODE_SHOW_TIME;
+        sscChangeDisplayMode(DISPLAY_MODE_SHOW_TIME);
 #endif
         sscStopSetting(clkTasks.set_time_mode);
         break;
@@ -1925,19 +2677,19 @@ void _checkBtnSetForTmSet(uint8_t &curHour,
 #if defined(SHOW_SECOND_COLUMN)
       case DISPLAY_MODE_SET_SECOND_COLUMN_ON_OFF:
 #endif
-        ssc_display_mode = DISPLAY_MODE_SHOW_TIME;
+        sscChangeDisplayMode(DISPLAY_MODE_SHOW_TIME);
         sscStopSetting(clkTasks.set_time_mode);
         break;
 #endif
       default:
-        ssc_display_mode = DISPLAY_MODE_SHOW_TIME;
+        sscChangeDisplayMode(DISPLAY_MODE_SHOW_TIME);
         sscStopSetting(clkTasks.set_time_mode);
         break;
       }
     }
     else
     {
-      ssc_display_mode = DISPLAY_MODE_SHOW_TIME;
+      sscChangeDisplayMode(DISPLAY_MODE_SHOW_TIME);
       sscStopSetting(clkTasks.set_time_mode);
     }
   }
@@ -1980,13 +2732,7 @@ void _checkBtnUpDownForTmSet(uint8_t &curHour,
 #endif
 #if defined(USE_CALENDAR)
     case DISPLAY_MODE_SET_DAY:
-      uint8_t i;
-      i = pgm_read_byte(&daysInMonth[curMinute - 1]);
-      if (curMinute == 2 && (clkClock.getCurTime().year() % 4 == 0))
-      {
-        i++;
-      }
-      sscCheckData(curHour, i, dir, 1);
+      sscCheckData(curHour, getDaysInMonth(curMinute, clkClock.getCurTime().year()), dir, 1);
       break;
     case DISPLAY_MODE_SET_MONTH:
       sscCheckData(curMinute, 12, dir, 1);
@@ -2091,7 +2837,8 @@ void sscShowTimeSetting()
       curMinute = clkClock.getCurTime().month();
       break;
     case DISPLAY_MODE_SET_YEAR:
-      curHour = 20;
+      // в curHour - век, в curMinute - год века
+      curHour = clkClock.getCurTime().year() / 100;
       curMinute = clkClock.getCurTime().year() % 100;
       break;
 #endif
@@ -2168,7 +2915,7 @@ void sscCheckSetButton()
     case DISPLAY_MODE_SHOW_TIME:
 #if defined(USE_ALARM)
 #if defined(USE_ONECLICK_TO_SET_ALARM)
-      ssc_display_mode = DISPLAY_MODE_ALARM_ON_OFF;
+      sscChangeDisplayMode(DISPLAY_MODE_ALARM_ON_OFF);
 #endif
 #endif
       break;
@@ -2182,7 +2929,7 @@ void sscCheckSetButton()
     case DISPLAY_MODE_SHOW_TIME:
 #if defined(USE_ALARM)
 #if !defined(USE_ONECLICK_TO_SET_ALARM)
-      ssc_display_mode = DISPLAY_MODE_ALARM_ON_OFF;
+      sscChangeDisplayMode(DISPLAY_MODE_ALARM_ON_OFF);
 #endif
 #endif
       break;
@@ -2194,14 +2941,14 @@ void sscCheckSetButton()
     switch (ssc_display_mode)
     {
     case DISPLAY_MODE_SHOW_TIME:
-      ssc_display_mode = DISPLAY_MODE_SET_HOUR;
+      sscChangeDisplayMode(DISPLAY_MODE_SET_HOUR);
       break;
 #if defined(USE_CALENDAR)
     case DISPLAY_MODE_SHOW_DATE:
 #if __USE_AUTO_SHOW_DATA__
       clkTasks.stopTask(clkTasks.auto_show_mode);
 #endif
-      ssc_display_mode = DISPLAY_MODE_SET_DAY;
+      sscChangeDisplayMode(DISPLAY_MODE_SET_DAY);
       break;
 #endif
     case DISPLAY_MODE_SET_HOUR:
@@ -2286,31 +3033,31 @@ void sscCheckUpDownButton()
     {
 #if defined(USE_TICKER_FOR_DATA)
       // вход в настройки анимации
-      ssc_display_mode = DISPLAY_MODE_SET_TICKER_ON_OFF;
+      sscChangeDisplayMode(DISPLAY_MODE_SET_TICKER_ON_OFF);
       clkButtons.resetButtonState(CLK_BTN_DOWN);
 #elif __USE_AUTO_SHOW_DATA__
       // вход в настройки периода автовывода на экран даты и/или температуры
-      ssc_display_mode = DISPLAY_MODE_SET_AUTO_SHOW_PERIOD;
+      sscChangeDisplayMode(DISPLAY_MODE_SET_AUTO_SHOW_PERIOD);
       clkButtons.resetButtonState(CLK_BTN_DOWN);
 #elif defined(WS2812_MATRIX_DISPLAY)
-      ssc_display_mode = DISPLAY_MODE_SET_COLOR_OF_NUMBER;
+      sscChangeDisplayMode(DISPLAY_MODE_SET_COLOR_OF_NUMBER);
       clkButtons.resetButtonState(CLK_BTN_DOWN);
 #elif defined(SHOW_SECOND_COLUMN)
       // вход в настройки секундного столбика
-      ssc_display_mode = DISPLAY_MODE_SET_SECOND_COLUMN_ON_OFF;
+      sscChangeDisplayMode(DISPLAY_MODE_SET_SECOND_COLUMN_ON_OFF);
       clkButtons.resetButtonState(CLK_BTN_DOWN);
 #endif
     }
 #if __USE_TEMP_DATA__
     if (clkButtons.getLastState(CLK_BTN_UP) == BTN_ONECLICK)
     {
-      ssc_display_mode = DISPLAY_MODE_SHOW_TEMP;
+      sscChangeDisplayMode(DISPLAY_MODE_SHOW_TEMP);
     }
 #endif
 #if defined(USE_CALENDAR)
     if (clkButtons.getLastState(CLK_BTN_DOWN) == BTN_ONECLICK)
     {
-      ssc_display_mode = DISPLAY_MODE_SHOW_DATE;
+      sscChangeDisplayMode(DISPLAY_MODE_SHOW_DATE);
     }
 #endif
     if (clkButtons.isSecondButtonPressed(CLK_BTN_UP, CLK_BTN_DOWN, BTN_LONGCLICK) ||
@@ -2318,12 +3065,12 @@ void sscCheckUpDownButton()
     {
 #if __USE_SET_BRIGHTNESS_MODE__
 #if __USE_LIGHT_SENSOR__
-      ssc_display_mode = DISPLAY_MODE_SET_BRIGHTNESS_MIN;
+      sscChangeDisplayMode(DISPLAY_MODE_SET_BRIGHTNESS_MIN);
 #else
-      ssc_display_mode = DISPLAY_MODE_SET_BRIGHTNESS_MAX;
+      sscChangeDisplayMode(DISPLAY_MODE_SET_BRIGHTNESS_MAX);
 #endif
 #elif __USE_LIGHT_SENSOR__
-      ssc_display_mode = DISPLAY_MODE_SET_LIGHT_THRESHOLD;
+      sscChangeDisplayMode(DISPLAY_MODE_SET_LIGHT_THRESHOLD);
 #endif
     }
     break;
@@ -2403,6 +3150,14 @@ void sscCheckButton()
   clkButtons.getButtonState(CLK_BTN_ADD2);
 }
 
+void sscChangeDisplayMode(clkDisplayMode _mode)
+{
+  ssc_display_mode = _mode;
+  ssc_display_mode_changed = true;
+  // событие - только уведомление подписчиков; задачи режима запускает shSimpleClock::tick() по флагу
+  clkEvents.post(CLK_EV_MODE, _mode);
+}
+
 void sscSetDisplayMode()
 {
   switch (ssc_display_mode)
@@ -2440,7 +3195,7 @@ void sscSetDisplayMode()
 #endif
     if (!clkTasks.getTaskState(clkTasks.auto_show_mode))
     {
-      sscAutoShowData();
+      clkTasks.taskExes(clkTasks.auto_show_mode, false);
     }
     break;
 #endif
@@ -2472,36 +3227,42 @@ void sscSetDisplayMode()
 }
 
 #if defined(USE_ALARM)
-void sscCheckAlarm()
+void sscCheckAlarm() { clkAlarm.tick(); }
+
+void sscAlarmTrigger()
 {
-  clkAlarm.tick(clkClock.getCurTime());
+  clkAlarm.trigger();
+  // пищалка запускается сразу из задачи по расписанию, без ожидания опроса
   if (clkAlarm.getAlarmState() == ALARM_YES &&
       !clkTasks.getTaskState(clkTasks.alarm_buzzer))
   {
-    sscRunAlarmBuzzer();
+    clkTasks.taskExes(clkTasks.alarm_buzzer, false);
+    clkEvents.post(CLK_EV_ALARM);
 #if defined USE_CLOCK_EVENT
     sscAlarmEvent.run();
 #endif
   }
 }
 
-void sscRunAlarmBuzzer()
+void sscSetAlarmSchedule()
+{
+  uint16_t x = clkAlarm.getAlarmPoint();
+  clkCron.setTaskSpec(clkCron.alarm_trigger, clkCronDaily(x / 60, x % 60));
+}
+
+void sscRunAlarmBuzzer(void *_state)
 {
 #if BUZZER_PIN >= 0
-  static uint8_t n = 0;
-  static uint8_t k = 0;
-  static uint8_t m = 0;
+  sscBuzzerState *st = static_cast<sscBuzzerState *>(_state);
   // "мелодия" пищалки: первая строка - частота, вторая строка - длительность
   static const PROGMEM uint32_t pick[2][8] = {
       {2000, 0, 2000, 0, 2000, 0, 2000, 0},
-      {70, 70, 70, 70, 70, 70, 70, 510}};
+      {70, 70, 70, 70, 70, 70, 70, 490}};
 
   if (!clkTasks.getTaskState(clkTasks.alarm_buzzer))
   {
     clkTasks.startTask(clkTasks.alarm_buzzer);
-    n = 0;
-    k = 0;
-    m = 0;
+    st->co.reset();
   }
   else if (clkAlarm.getAlarmState() == ALARM_ON)
   { // остановка пищалки, если будильник отключен
@@ -2509,31 +3270,33 @@ void sscRunAlarmBuzzer()
     return;
   }
 
-  tone(BUZZER_PIN,
-       pgm_read_dword(&pick[0][n]),
-       pgm_read_dword(&pick[1][n]));
-  clkTasks.setTaskInterval(clkTasks.alarm_buzzer,
-                           pgm_read_dword(&pick[1][n]), true);
-  if (++n >= 8)
+  CLK_CO_BEGIN(st->co);
+  for (st->repeat = 0; st->repeat < ALARM_REPETITION_COUNT; st->repeat++)
   {
-    n = 0;
-    if (++k >= ALARM_DURATION)
-    { // приостановка пищалки через заданное число секунд
-      k = 0;
-      if (++m >= ALARM_REPETITION_COUNT)
-      { // отключение пищалки после заданного количества срабатываний
-        clkTasks.stopTask(clkTasks.alarm_buzzer);
-        clkTasks.setTaskInterval(clkTasks.alarm_buzzer, 50, false);
-        clkAlarm.setAlarmState(ALARM_ON);
-      }
-      else
+    // "мелодия" проигрывается ALARM_DURATION раз, т.е. примерно заданное число секунд
+    for (st->cycle = 0; st->cycle < ALARM_DURATION; st->cycle++)
+    {
+      for (st->note = 0; st->note < 8; st->note++)
       {
-        clkTasks.setTaskInterval(clkTasks.alarm_buzzer,
-                                 ALARM_SNOOZE_DELAY * 1000ul,
-                                 true);
+        tone(BUZZER_PIN,
+             pgm_read_dword(&pick[0][st->note]),
+             pgm_read_dword(&pick[1][st->note]));
+        st->wait = pgm_read_dword(&pick[1][st->note]) / SSC_BUZZER_INTERVAL;
+        do
+        {
+          CLK_CO_YIELD(st->co);
+        } while (--st->wait);
       }
     }
+    if (st->repeat + 1 < ALARM_REPETITION_COUNT)
+    { // приостановка пищалки до следующего срабатывания
+      CLK_CO_DELAY(st->co, ALARM_SNOOZE_DELAY * 1000ul);
+    }
   }
+  // отключение пищалки после заданного количества срабатываний
+  clkTasks.stopTask(clkTasks.alarm_buzzer);
+  clkAlarm.setAlarmState(ALARM_ON);
+  CLK_CO_END(st->co);
 #endif
 }
 
@@ -2568,6 +3331,13 @@ void sscSetBrightness()
     x = read_eeprom_8(MAX_BRIGHTNESS_VALUE_EEPROM_INDEX);
   }
   clkDisplay.setBrightness(x);
+
+  static uint8_t last = 0;
+  if (x != last)
+  {
+    last = x;
+    clkEvents.post(CLK_EV_SENSOR, CLK_SENSOR_LIGHT);
+  }
 }
 
 #endif
@@ -2575,9 +3345,21 @@ void sscSetBrightness()
 #if __USE_TEMP_DATA__
 
 #if defined(USE_DS18B20)
-void sscCheckDS18b20()
+void sscCheckDS18b20(void *_state)
 {
-  sscTempSensor.readData();
+  sscDS18b20State *st = static_cast<sscDS18b20State *>(_state);
+
+  CLK_CO_BEGIN(st->co);
+  for (;;)
+  {
+    sscTempSensor.startConversion();
+    CLK_CO_DELAY(st->co, DS18B20_CONVERSION_TIME);
+    sscTempSensor.readData();
+    clkEvents.post(CLK_EV_SENSOR, CLK_SENSOR_TEMP);
+    // датчик опрашивается раз в три секунды, чтобы не разогревать его
+    CLK_CO_DELAY(st->co, 3000ul - DS18B20_CONVERSION_TIME);
+  }
+  CLK_CO_END(st->co);
 }
 #endif
 
@@ -2586,7 +3368,7 @@ int8_t sscGetCurTemp()
   int8_t result = -127;
 #if defined(USE_DS18B20) || defined(USE_NTC)
   result = sscTempSensor.getTemp();
-#elif defined(RTC_DS3231)
+#elif defined(RTC_DS3231) || defined(RTC_AUTO_DETECT)
   result = clkClock.getTemperature();
 #endif
 
@@ -2650,7 +3432,7 @@ void _checkBtnSetForOthSet(uint8_t &x)
 #if __USE_LIGHT_SENSOR__
     case DISPLAY_MODE_SET_LIGHT_THRESHOLD:
       write_eeprom_8(LIGHT_THRESHOLD_EEPROM_INDEX, x);
-      ssc_display_mode = DISPLAY_MODE_SHOW_TIME;
+      sscChangeDisplayMode(DISPLAY_MODE_SHOW_TIME);
       sscStopSetting(clkTasks.other_setting_mode);
       break;
 #endif
@@ -2660,12 +3442,12 @@ void _checkBtnSetForOthSet(uint8_t &x)
 #if __USE_LIGHT_SENSOR__
       if (_next)
       {
-        ssc_display_mode = DISPLAY_MODE_SET_LIGHT_THRESHOLD;
+        sscChangeDisplayMode(DISPLAY_MODE_SET_LIGHT_THRESHOLD);
       }
       else
 #endif
       {
-        ssc_display_mode = DISPLAY_MODE_SHOW_TIME;
+        sscChangeDisplayMode(DISPLAY_MODE_SHOW_TIME);
       }
       sscStopSetting(clkTasks.other_setting_mode);
       break;
@@ -2674,11 +3456,11 @@ void _checkBtnSetForOthSet(uint8_t &x)
       write_eeprom_8(MIN_BRIGHTNESS_VALUE_EEPROM_INDEX, x);
       if (_next)
       {
-        ssc_display_mode = DISPLAY_MODE_SET_BRIGHTNESS_MAX;
+        sscChangeDisplayMode(DISPLAY_MODE_SET_BRIGHTNESS_MAX);
       }
       else
       {
-        ssc_display_mode = DISPLAY_MODE_SHOW_TIME;
+        sscChangeDisplayMode(DISPLAY_MODE_SHOW_TIME);
       }
       sscStopSetting(clkTasks.other_setting_mode);
       break;
@@ -2687,21 +3469,22 @@ void _checkBtnSetForOthSet(uint8_t &x)
 #if __USE_AUTO_SHOW_DATA__
     case DISPLAY_MODE_SET_AUTO_SHOW_PERIOD:
       write_eeprom_8(INTERVAL_FOR_AUTOSHOWDATA_EEPROM_INDEX, x);
+      sscSetAutoShowSchedule();
 #if defined(WS2812_MATRIX_DISPLAY)
       if (_next)
       {
-        ssc_display_mode = DISPLAY_MODE_SET_COLOR_OF_NUMBER;
+        sscChangeDisplayMode(DISPLAY_MODE_SET_COLOR_OF_NUMBER);
       }
       else
 #elif defined(SHOW_SECOND_COLUMN)
       if (_next)
       {
-        ssc_display_mode = DISPLAY_MODE_SET_SECOND_COLUMN_ON_OFF;
+        sscChangeDisplayMode(DISPLAY_MODE_SET_SECOND_COLUMN_ON_OFF);
       }
       else
 #endif
       {
-        ssc_display_mode = DISPLAY_MODE_SHOW_TIME;
+        sscChangeDisplayMode(DISPLAY_MODE_SHOW_TIME);
       }
       sscStopSetting(clkTasks.other_setting_mode);
       break;
@@ -2714,12 +3497,12 @@ void _checkBtnSetForOthSet(uint8_t &x)
 #if defined(SHOW_SECOND_COLUMN)
       if (_next)
       {
-        ssc_display_mode = DISPLAY_MODE_SET_SECOND_COLUMN_ON_OFF;
+        sscChangeDisplayMode(DISPLAY_MODE_SET_SECOND_COLUMN_ON_OFF);
       }
       else
 #endif
       {
-        ssc_display_mode = DISPLAY_MODE_SHOW_TIME;
+        sscChangeDisplayMode(DISPLAY_MODE_SHOW_TIME);
       }
       sscStopSetting(clkTasks.other_setting_mode);
       break;
@@ -2928,9 +3711,7 @@ void _setDisplayForAutoShowData(uint8_t &n)
     else
 #endif
     {
-      sscSetDayOfWeakString(7, getDayOfWeek(clkClock.getCurTime().day(),
-                                            clkClock.getCurTime().month(),
-                                            clkClock.getCurTime().year()));
+      sscSetDayOfWeakString(7, clkClock.getCurDayOfWeek());
     }
     break;
   case 1:
@@ -2959,7 +3740,7 @@ void _setDisplayForAutoShowData(uint8_t &n)
     else
 #endif
     {
-      sscSetYearString(1, clkClock.getCurTime().year());
+      sscSetYearString(1, clkClock.getCurTime().year() / 100, clkClock.getCurTime().year() % 100);
     }
     break;
 #endif
@@ -3022,28 +3803,26 @@ void _setDisplayForAutoShowData(uint8_t &n)
 
 #endif
 
-void sscAutoShowData()
+void sscAutoShowData(void *_state)
 {
-  static uint8_t n = 0;
-  static uint8_t n_max = 0;
-  static unsigned long timer = 0;
+  sscAutoShowState *st = static_cast<sscAutoShowState *>(_state);
 
   if (!clkTasks.getTaskState(clkTasks.auto_show_mode))
   {
-    _startAutoShowMode(n, n_max);
+    _startAutoShowMode(st->n, st->n_max);
   }
 
 #if defined(USE_TICKER_FOR_DATA)
   if (clkTasks.getTaskState(clkTasks.ticker))
   {
-    timer = millis();
+    st->timer = millis();
     return;
   }
 #endif
 
-  if (millis() - timer >= 1000)
+  if (millis() - st->timer >= 1000)
   {
-    timer = millis();
+    st->timer = millis();
 #if defined(USE_TICKER_FOR_DATA)
     if (!read_eeprom_8(TICKER_STATE_VALUE_EEPROM_INDEX))
     {
@@ -3052,15 +3831,37 @@ void sscAutoShowData()
 #else
     clkDisplay.clear();
 #endif
-    _setDisplayForAutoShowData(n);
+    _setDisplayForAutoShowData(st->n);
 
-    if (++n > n_max)
+    if (++st->n > st->n_max)
     {
       sscReturnToDefMode();
     }
   }
 }
 
+void sscStartAutoShow()
+{
+  // автовывод запускается только из режима показа времени и не прерывает бегущую строку
+#if defined(USE_TICKER_FOR_DATA)
+  if (clkTasks.getTaskState(clkTasks.ticker))
+  {
+    return;
+  }
+#endif
+  if (ssc_display_mode == DISPLAY_MODE_SHOW_TIME)
+  {
+    sscChangeDisplayMode(DISPLAY_AUTO_SHOW_DATA);
+  }
+}
+
+void sscSetAutoShowSchedule()
+{
+  // период 0 - автовывод отключен; такое расписание не срабатывает никогда
+  uint8_t x = sscGetPeriodForAutoShow(read_eeprom_8(INTERVAL_FOR_AUTOSHOWDATA_EEPROM_INDEX));
+  clkCron.setTaskSpec(clkCron.auto_show_trigger, clkCronEvery(x, (x) ? CLK_EVERY_DAY : 0));
+}
+
 uint8_t sscGetPeriodForAutoShow(uint8_t index)
 {
   uint8_t result = index;
@@ -3095,22 +3896,23 @@ void sscShowOnOffData(clkDataType _type, bool _state, bool blink)
 
 #if __USE_MATRIX_DISPLAY__
 
-void sscSetTimeString(uint8_t offset,
+void sscSetTimeString(uint16_t offset,
                       int8_t hour,
                       int8_t minute,
                       bool show_colon,
                       bool toDate,
-                      bool toStringData)
+                      bool toStringData,
+                      uint8_t line)
 {
   if (hour >= 0)
   {
     if (toDate)
     {
-      sscSetNumString(offset, hour, 5, 1, toStringData, true);
+      sscSetNumString(offset, hour, 5, 1, toStringData, true, line);
     }
     else
     {
-      sscSetNumString(offset, hour, 6, 1, toStringData);
+      sscSetNumString(offset, hour, 6, 1, toStringData, false, line);
     }
   }
   if (minute >= 0)
@@ -3122,29 +3924,26 @@ void sscSetTimeString(uint8_t offset,
         sscSetChar(offset + 13 + j * 6,
                    pgm_read_byte(&months[(minute - 1) * 3 + j]),
                    5,
-                   toStringData);
+                   toStringData,
+                   line);
       }
     }
     else
     {
-      sscSetNumString(offset + 16, minute, 6, 1, toStringData);
+      sscSetNumString(offset + 16, minute, 6, 1, toStringData, false, line);
     }
   }
   if (show_colon && !toDate)
   {
-    if (toStringData)
+    if (toStringData || !sscBlinkFlag || ssc_display_mode != DISPLAY_MODE_SHOW_TIME)
     {
-      sData.setData(offset + 14, 0b00100100);
-    }
-    else if (!sscBlinkFlag || ssc_display_mode != DISPLAY_MODE_SHOW_TIME)
-    {
-      clkDisplay.setColumn(offset + 14, 0b00100100);
+      sscSetColumn(offset + 14, 0b00100100, toStringData, line);
     }
   }
 }
 
 void sscSetOtherDataString(clkDataType _type,
-                           uint8_t offset,
+                           uint16_t offset,
                            uint8_t _data,
                            bool blink,
                            bool toStringData)
@@ -3181,14 +3980,7 @@ void sscSetOtherDataString(clkDataType _type,
   default:
     break;
   }
-  if (toStringData)
-  {
-    sData.setData(offset + 18, 0x24); // ":"
-  }
-  else
-  {
-    clkDisplay.setColumn(offset + 18, 0x24); // ":"
-  }
+  sscSetColumn(offset + 18, 0x24, toStringData); // ":"
 
   if (!blink)
   {
@@ -3205,7 +3997,7 @@ void sscSetOtherDataString(clkDataType _type,
   }
 }
 
-void sscSetTag(uint8_t offset, uint8_t index, uint8_t width, bool toStringData)
+void sscSetTag(uint16_t offset, uint8_t index, uint8_t width, bool toStringData)
 {
   for (uint8_t i = 0; i < 3; i++)
   {
@@ -3217,7 +4009,7 @@ void sscSetTag(uint8_t offset, uint8_t index, uint8_t width, bool toStringData)
 }
 
 void sscSetOnOffDataString(clkDataType _type,
-                           uint8_t offset,
+                           uint16_t offset,
                            bool _state,
                            bool _blink,
                            bool toStringData)
@@ -3243,14 +4035,7 @@ void sscSetOnOffDataString(clkDataType _type,
     break;
   }
 
-  if (toStringData)
-  {
-    sData.setData(offset + 20, 0x24); // ":"
-  }
-  else
-  {
-    clkDisplay.setColumn(offset + 20, 0x24); // ":"
-  }
+  sscSetColumn(offset + 20, 0x24, toStringData); // ":"
 
   if (!_blink)
   {
@@ -3258,30 +4043,31 @@ void sscSetOnOffDataString(clkDataType _type,
   }
 }
 
-void sscSetNumString(uint8_t offset,
+void sscSetNumString(uint16_t offset,
                      uint8_t num,
                      uint8_t width,
                      uint8_t space,
                      bool toStringData,
-                     bool firstSpace)
+                     bool firstSpace,
+                     uint8_t line)
 {
   if (firstSpace && num < 10)
   {
     uint8_t x = (width == 6) ? num % 10 : num % 10 + 0x30;
-    sscSetChar(offset + 5, x, width, toStringData);
+    sscSetChar(offset + 5, x, width, toStringData, line);
   }
   else
   {
     uint8_t x = (width == 6) ? num / 10 : num / 10 + 0x30;
-    sscSetChar(offset, x, width, toStringData);
+    sscSetChar(offset, x, width, toStringData, line);
     x = (width == 6) ? num % 10 : num % 10 + 0x30;
-    sscSetChar(offset + width + space, x, width, toStringData);
+    sscSetChar(offset + width + space, x, width, toStringData, line);
   }
 }
 
-void sscSetChar(uint8_t offset, uint8_t chr, uint8_t width, bool toStringData)
+void sscSetChar(uint16_t offset, uint8_t chr, uint8_t width, bool toStringData, uint8_t line)
 {
-  for (uint8_t j = offset, i = 0; i < width; j++, i++)
+  for (uint16_t j = offset, i = 0; i < width; j++, i++)
   {
     uint8_t chr_data = 0;
     switch (width)
@@ -3296,50 +4082,65 @@ void sscSetChar(uint8_t offset, uint8_t chr, uint8_t width, bool toStringData)
       break;
     }
 
-    if (toStringData)
-    {
-      if (j < sData.getDataLenght())
-      {
-        sData.setData(j, chr_data);
-      }
-    }
-    else
-    {
-      if (j < 32)
-      {
-        clkDisplay.setColumn(j, chr_data);
-      }
-    }
+    sscSetColumn(j, chr_data, toStringData, line);
+  }
+}
+
+void sscSetColumn(uint16_t col, uint8_t _data, bool toStringData, uint8_t line)
+{
+  if (toStringData)
+  {
+    sData.setData(col, _data);
+  }
+  else if (col + MATRIX_DATA_OFFSET < MATRIX_WIDTH)
+  {
+    clkDisplay.setColumn(col + MATRIX_DATA_OFFSET, _data, line);
   }
 }
 
 #if defined(USE_TICKER_FOR_DATA)
-void sscAssembleString(clkDisplayMode data_type, uint8_t lenght)
+void sscAssembleString(clkDisplayMode data_type, uint16_t lenght)
 {
+#if defined(USE_DIGIT_ANIMATION)
+  // перед копированием экрана в строку дорисовать цифры, если идет анимация их смены
+  sscStopDigitAnimation();
+#endif
+
   if (!sData.stringInit(lenght))
     return;
 
   // скопировать в начало строки содержимое экрана
-  for (uint8_t i = 0; i < 32; i++)
+  for (uint16_t i = 0; i < MATRIX_WIDTH; i++)
   {
     sData.setData(i, clkDisplay.getColumn(i));
   }
 
+  // начало блока данных во второй части строки; вторая часть строки по окончании прокрутки займет весь экран
+  uint16_t x = lenght - MATRIX_WIDTH + MATRIX_DATA_OFFSET;
+
   // сформировать вторую часть строки
   switch (data_type)
   {
   case DISPLAY_MODE_SHOW_TIME: // время
-    sscSetTimeString(lenght - 31,
+    sscSetTimeString(x + 1,
                      clkClock.getCurTime().hour(),
                      clkClock.getCurTime().minute(),
                      true,
                      false,
                      true);
+#if __USE_DATE_WITH_TIME__ && MATRIX_HEIGHT < 16
+    sscSetTimeString(x + MATRIX_DATE_OFFSET + 1,
+                     clkClock.getCurTime().day(),
+                     clkClock.getCurTime().month(),
+                     true,
+                     true,
+                     true);
+#endif
     break;
 
 #if __USE_TEMP_DATA__
   case DISPLAY_MODE_SHOW_TEMP: // температура
-    sscSetTempString(lenght - 31, sscGetCurTemp(), true);
+    sscSetTempString(x + 1, sscGetCurTemp(), true);
     break;
 #endif
 
@@ -3348,18 +4149,18 @@ void sscAssembleString(clkDisplayMode data_type, uint8_t lenght)
 #if __USE_LIGHT_SENSOR__
   case DISPLAY_MODE_SET_BRIGHTNESS_MIN:
 #endif
-    uint8_t x;
+    uint8_t z;
     if (ssc_display_mode == DISPLAY_MODE_SET_BRIGHTNESS_MAX)
     {
-      x = read_eeprom_8(MAX_BRIGHTNESS_VALUE_EEPROM_INDEX);
+      z = read_eeprom_8(MAX_BRIGHTNESS_VALUE_EEPROM_INDEX);
     }
 #if __USE_LIGHT_SENSOR__
     else
     {
-      x = read_eeprom_8(MIN_BRIGHTNESS_VALUE_EEPROM_INDEX);
+      z = read_eeprom_8(MIN_BRIGHTNESS_VALUE_EEPROM_INDEX);
     }
 #endif
-    sscSetOtherDataString(SET_BRIGHTNESS_TAG, lenght - 31, x, false, true);
+    sscSetOtherDataString(SET_BRIGHTNESS_TAG, x + 1, z, false, true);
     break;
 #endif
 
@@ -3367,13 +4168,13 @@ void sscAssembleString(clkDisplayMode data_type, uint8_t lenght)
   case DISPLAY_MODE_SET_LIGHT_THRESHOLD: // настройка порога переключения яркости
     uint8_t y;
     y = read_eeprom_8(LIGHT_THRESHOLD_EEPROM_INDEX);
-    sscSetOtherDataString(SET_LIGHT_THRESHOLD_TAG, lenght - 31, y, false, true);
+    sscSetOtherDataString(SET_LIGHT_THRESHOLD_TAG, x + 1, y, false, true);
     break;
 #endif
 
 #if defined(USE_ALARM)
   case DISPLAY_MODE_SET_ALARM_HOUR: // настройка часа срабатывания будильника
-    sscSetTimeString(lenght - 31,
+    sscSetTimeString(x + 1,
                      clkAlarm.getAlarmPoint() / 60,
                      clkAlarm.getAlarmPoint() % 60,
                      true,
@@ -3381,14 +4182,14 @@ void sscAssembleString(clkDisplayMode data_type, uint8_t lenght)
                      true);
     break;
   case DISPLAY_MODE_ALARM_ON_OFF: // настройка включения/выключения будильника
-    sscSetOnOffDataString(SET_ALARM_TAG, lenght - 31, clkAlarm.getOnOffAlarm(), false, true);
+    sscSetOnOffDataString(SET_ALARM_TAG, x + 1, clkAlarm.getOnOffAlarm(), false, true);
     break;
 #endif
 
 #if defined(SHOW_SECOND_COLUMN)
   case DISPLAY_MODE_SET_SECOND_COLUMN_ON_OFF: // настройка включения/выключения секундного столбика
     sscSetOnOffDataString(SET_SECOND_COLUMN_TAG,
-                          lenght - 31,
+                          x + 1,
                           (bool)read_eeprom_8(SECOND_COLUMN_ON_OF_DATA_EEPROM_INDEX),
                           false,
                           true);
@@ -3397,16 +4198,12 @@ void sscAssembleString(clkDisplayMode data_type, uint8_t lenght)
 
 #if defined(USE_CALENDAR)
   case DISPLAY_MODE_SHOW_DOW: // день недели
-    sscSetDayOfWeakString(lenght - 25,
-                          getDayOfWeek(clkClock.getCurTime().day(),
-                                       clkClock.getCurTime().month(),
-                                       clkClock.getCurTime().year()),
-                          true);
+    sscSetDayOfWeakString(x + 7, clkClock.getCurDayOfWeek(), true);
     break;
 
   case DISPLAY_MODE_SHOW_DAY_AND_MONTH: // число и месяц
   case DISPLAY_MODE_SET_DAY:            // настройка числа
-    sscSetTimeString(lenght - 31,
+    sscSetTimeString(x + 1,
                      clkClock.getCurTime().day(),
                      clkClock.getCurTime().month(),
                      true,
@@ -3416,13 +4213,13 @@ void sscAssembleString(clkDisplayMode data_type, uint8_t lenght)
 
   case DISPLAY_MODE_SHOW_YEAR: // год
   case DISPLAY_MODE_SET_YEAR:  // настройка года
-    sscSetYearString(lenght - 31, clkClock.getCurTime().year(), true);
+    sscSetYearString(x + 1, clkClock.getCurTime().year() / 100, clkClock.getCurTime().year() % 100, true);
     break;
 #endif
 #if defined(USE_TICKER_FOR_DATA)
   case DISPLAY_MODE_SET_TICKER_ON_OFF: // настройка включения/выключения анимации
     sscSetOnOffDataString(SET_TICKER_TAG,
-                          lenght - 31,
+                          x + 1,
                           read_eeprom_8(TICKER_STATE_VALUE_EEPROM_INDEX),
                           false,
                           true);
@@ -3431,7 +4228,7 @@ void sscAssembleString(clkDisplayMode data_type, uint8_t lenght)
 #if __USE_AUTO_SHOW_DATA__
   case DISPLAY_MODE_SET_AUTO_SHOW_PERIOD:
     sscSetOtherDataString(SET_AUTO_SHOW_PERIOD_TAG,
-                          lenght - 31,
+                          x + 1,
                           sscGetPeriodForAutoShow(read_eeprom_8(INTERVAL_FOR_AUTOSHOWDATA_EEPROM_INDEX)),
                           false,
                           true);
@@ -3440,7 +4237,7 @@ void sscAssembleString(clkDisplayMode data_type, uint8_t lenght)
 #if defined(WS2812_MATRIX_DISPLAY)
   case DISPLAY_MODE_SET_COLOR_OF_NUMBER:
     sscSetOtherDataString(SET_COLOR_OF_NUMBER_TAG,
-                          lenght - 31,
+                          x + 1,
                           sscGetIndexOfCurrentColorOfNumber(),
                           false,
                           true);
@@ -3449,26 +4246,26 @@ void sscAssembleString(clkDisplayMode data_type, uint8_t lenght)
   default:
     break;
   }
-  sscRunTicker();
+  clkTasks.taskExes(clkTasks.ticker, false);
 }
 
-void sscRunTicker()
+void sscRunTicker(void *_state)
 {
-  static uint8_t n = 0;
+  sscTickerState *st = static_cast<sscTickerState *>(_state);
 
   if (!clkTasks.getTaskState(clkTasks.ticker))
   {
     clkTasks.startTask(clkTasks.ticker);
-    n = 0;
+    st->pos = 0;
   }
 
-  for (uint8_t i = 0; i < 32; i++)
+  for (uint16_t i = 0; i < MATRIX_WIDTH; i++)
   {
-    clkDisplay.setColumn(i, sData.getData(i + n));
+    clkDisplay.setColumn(i, sData.getData(i + st->pos));
   }
   clkDisplay.show();
 
-  if (n++ >= sData.getDataLenght() - 32)
+  if (st->pos++ >= sData.getDataLenght() - MATRIX_WIDTH)
   {
     clkTasks.stopTask(clkTasks.ticker);
     sData.stringFree();
@@ -3477,8 +4274,69 @@ void sscRunTicker()
 
 #endif
 
+#if defined(USE_DIGIT_ANIMATION)
+void sscCheckDigitAnimation(uint8_t offset, int8_t hour, int8_t minute)
+{
+  if (sscDigitAnimation.setTime(offset, hour, minute))
+  {
+    clkTasks.startTask(clkTasks.digit_animation);
+  }
+
+  // экран перерисовывается целиком, поэтому поверх него нужно заново вывести текущий кадр анимации
+  if (clkTasks.getTaskState(clkTasks.digit_animation))
+  {
+    sscSetDigitAnimationFrame();
+  }
+}
+
+void sscSetDigitAnimationFrame()
+{
+  // за один кадр перерисовывается не более 24 столбцов - только изменившиеся цифры
+  for (uint8_t i = 0; i < 4; i++)
+  {
+    if (sscDigitAnimation.isDigitChanged(i))
+    {
+      uint16_t offset = sscDigitAnimation.getDigitOffset(i) + MATRIX_DATA_OFFSET;
+      for (uint8_t j = 0; j < 6; j++)
+      {
+        clkDisplay.setColumnTransition(offset + j,
+                                       sscDigitAnimation.getOldColumn(i, j),
+                                       sscDigitAnimation.getNewColumn(i, j),
+                                       sscDigitAnimation.getStep());
+      }
+    }
+  }
+}
+
+void sscRunDigitAnimation()
+{
+  // при смене режима экрана анимация прекращается
+  if (ssc_display_mode != DISPLAY_MODE_SHOW_TIME)
+  {
+    sscStopDigitAnimation();
+    return;
+  }
+
+  if (!sscDigitAnimation.nextStep())
+  {
+    clkTasks.stopTask(clkTasks.digit_animation);
+  }
+  sscSetDigitAnimationFrame();
+}
+
+void sscStopDigitAnimation()
+{
+  if (clkTasks.getTaskState(clkTasks.digit_animation))
+  {
+    clkTasks.stopTask(clkTasks.digit_animation);
+    sscDigitAnimation.finish();
+    sscSetDigitAnimationFrame();
+  }
+}
+#endif
+
 #if defined(USE_CALENDAR)
-void sscSetDayOfWeakString(uint8_t offset, uint8_t dow, bool toStringData)
+void sscSetDayOfWeakString(uint16_t offset, uint8_t dow, bool toStringData)
 {
   for (uint8_t j = 0; j < 3; j++)
   {
@@ -3487,18 +4345,18 @@ void sscSetDayOfWeakString(uint8_t offset, uint8_t dow, bool toStringData)
   }
 }
 
-void sscSetYearString(uint8_t offset, int16_t _year, bool toStringData)
+void sscSetYearString(uint16_t offset, uint8_t _century, int8_t _year, bool toStringData)
 {
-  sscSetNumString(offset, 20, 6, 2, toStringData);
+  sscSetNumString(offset, _century, 6, 2, toStringData);
   if (_year >= 0)
   {
-    sscSetNumString(offset + 16, _year % 2000, 6, 2, toStringData);
+    sscSetNumString(offset + 16, _year, 6, 2, toStringData);
   }
 }
 #endif
 
 #if __USE_TEMP_DATA__
-void sscSetTempString(uint8_t offset, int16_t temp, bool toStringData)
+void sscSetTempString(uint16_t offset, int16_t temp, bool toStringData)
 {
   // если температура выходит за диапазон, сформировать строку минусов
   if (temp > 99 || temp < -99)
@@ -3511,7 +4369,7 @@ void sscSetTempString(uint8_t offset, int16_t temp, bool toStringData)
   else
   {
     bool plus = temp > 0;
-    uint8_t plus_pos = offset + 6;
+    uint16_t plus_pos = offset + 6;
     if (temp < 0)
     {
       temp = -temp;
@@ -3740,7 +4598,7 @@ void sscShowDate(clkDateTime date)
 #if defined(LCD_I2C_DISPLAY)
     clkDisplay.setColon(false, LCD_COLON_NO_COLON);
 #endif
-    sscShowTime(20, date.year() % 100, false);
+    sscShowTime(date.year() / 100, date.year() % 100, false);
     break;
   }
 
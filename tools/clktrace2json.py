@@ -0,0 +1,161 @@
+#!/usr/bin/env python3
+"""Convert a shSimpleClock task trace dump into Chrome trace / Perfetto JSON.
+
+The dump is the text printed by shSimpleClock::dumpTaskTrace() (USE_TASK_TRACE
+option). Capture it from any serial monitor, save it to a file and run:
+
+    python3 tools/clktrace2json.py dump.txt -o trace.json
+
+then open trace.json in https://ui.perfetto.dev or chrome://tracing.
+Text around the dump (other serial output) is ignored, as are lines inside
+the dump that cannot be parsed; if the input holds several dumps, each one
+becomes a separate process in the timeline.
+
+    python3 tools/clktrace2json.py --selftest
+
+checks the converter on a built-in sample, including a micros() rollover
+and stray lines inside the dump.
+"""
+
+import argparse
+import json
+import sys
+
+MICROS_RANGE = 1 << 32
+FORMAT_VERSION = 1
+
+
+def parse_dumps(lines):
+    """Return a list of dumps: dicts with 'names', 'lost' and 'records'."""
+    dumps = []
+    cur = None
+    for raw in lines:
+        line = raw.strip()
+        if line.startswith("#clktrace"):
+            parts = line.split()
+            version = int(parts[1]) if len(parts) > 1 else 0
+            if version != FORMAT_VERSION:
+                raise ValueError("unsupported trace format version %d" % version)
+            cur = {"names": {}, "lost": 0, "records": []}
+            continue
+        if cur is None or not line:
+            continue
+        if line == "#end":
+            dumps.append(cur)
+            cur = None
+            continue
+        try:
+            if line.startswith("#lost"):
+                cur["lost"] = int(line.split()[1])
+            elif line.startswith("@"):
+                handle, _, name = line[1:].partition(" ")
+                if int(handle) >= 0:
+                    cur["names"][int(handle)] = name.strip()
+            else:
+                task, start, end = (int(x) for x in line.split())
+                cur["records"].append((task, start, end))
+        except (ValueError, IndexError):
+            # other serial output mixed into the dump, or a damaged line
+            continue
+    if cur is not None:
+        # dump was cut off - keep what was received
+        dumps.append(cur)
+    return dumps
+
+
+def to_events(dump, pid):
+    """Convert one dump to trace events; timestamps start at zero."""
+    events = [
+        {"ph": "M", "name": "process_name", "pid": pid,
+         "args": {"name": "shSimpleClock dump %d" % pid}},
+        {"ph": "M", "name": "thread_name", "pid": pid, "tid": 1,
+         "args": {"name": "loop"}},
+    ]
+    if dump["lost"]:
+        events.append({"ph": "i", "s": "p", "name": "%d records lost before this point" % dump["lost"],
+                       "pid": pid, "tid": 1, "ts": 0})
+
+    base = None
+    last = None
+    offset = 0
+    for task, start, end in dump["records"]:
+        # records go from oldest to newest, so a start time that jumps back
+        # by more than half the range means micros() rolled over
+        if last is not None and start < last and last - start > MICROS_RANGE // 2:
+            offset += MICROS_RANGE
+        last = start
+        ts = start + offset
+        if base is None:
+            base = ts
+        events.append({
+            "ph": "X",
+            "name": dump["names"].get(task, "task %d" % task),
+            "pid": pid,
+            "tid": 1,
+            "ts": ts - base,
+            "dur": (end - start) % MICROS_RANGE,
+            "args": {"task": task},
+        })
+    return events
+
+
+def convert(lines):
+    events = []
+    for pid, dump in enumerate(parse_dumps(lines), 1):
+        events.extend(to_events(dump, pid))
+    return {"traceEvents": events, "displayTimeUnit": "ms"}
+
+
+SAMPLE = """\
+boot message from the sketch
+#clktrace 1
+#lost 3
+@0 sscRtcNow
+@4 sscShowDisplay
+0 4294967000 4294967100
+debug print from an event handler
+4 4294967200 50
+4 12
+7 100 400
+#end
+"""
+
+
+def selftest():
+    trace = convert(SAMPLE.splitlines())
+    spans = [e for e in trace["traceEvents"] if e["ph"] == "X"]
+    assert [e["name"] for e in spans] == ["sscRtcNow", "sscShowDisplay", "task 7"], spans
+    assert [e["ts"] for e in spans] == [0, 200, 396], spans
+    assert [e["dur"] for e in spans] == [100, 146, 300], spans
+    assert any(e["ph"] == "i" for e in trace["traceEvents"])
+    json.dumps(trace)
+    print("selftest passed")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("input", nargs="?", help="dump file; stdin if omitted")
+    parser.add_argument("-o", "--output", help="output JSON file; stdout if omitted")
+    parser.add_argument("--selftest", action="store_true", help="check the converter and exit")
+    args = parser.parse_args()
+
+    if args.selftest:
+        selftest()
+        return 0
+
+    src = open(args.input) if args.input else sys.stdin
+    with src:
+        trace = convert(src)
+    if not any(e["ph"] == "X" for e in trace["traceEvents"]):
+        print("no trace records found", file=sys.stderr)
+        return 1
+
+    dst = open(args.output, "w") if args.output else sys.stdout
+    with dst:
+        json.dump(trace, dst, indent=1)
+        dst.write("\n")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
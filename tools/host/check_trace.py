@@ -0,0 +1,28 @@
+#!/usr/bin/env python3
+"""Check the JSON that clktrace2json.py made from the trace_dump.cpp output."""
+
+import json
+import sys
+
+TRACE_BUFFER_SIZE = 64  # default from clockSetting.h
+WORK_TIME = 2000  # sensorTask() duration in trace_dump.cpp, us
+
+
+def main():
+    with open(sys.argv[1]) as f:
+        events = json.load(f)["traceEvents"]
+    spans = [e for e in events if e["ph"] == "X"]
+    names = sorted(set(e["name"] for e in spans))
+    print("task trace: %d spans; %s" % (len(spans), ", ".join(names)))
+
+    ok = (len(spans) == TRACE_BUFFER_SIZE
+          and "sscShowDisplay" in names
+          and any(e["dur"] == WORK_TIME for e in spans)
+          and all(a["ts"] <= b["ts"] for a, b in zip(spans, spans[1:]))
+          and any(e["ph"] == "i" for e in events))
+    print("  " + ("ok" if ok else "FAILED"))
+    return 0 if ok else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
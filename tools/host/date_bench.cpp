@@ -0,0 +1,165 @@
+/*
+ * сравнение преобразований дата <-> unixtime в clkDateTime с прежними
+ * (циклы по годам и месяцам из DateTime от JeeLabs/Adafruit) на 1 000 000
+ * случайных моментов времени, а также сверка результатов с gmtime();
+ * собирается и запускается из tools/host/run.sh
+ */
+#include "clockSetting.h"
+#include <clkSimpleRTC.h>
+#include <time.h>
+#include <chrono>
+
+// ---- прежняя реализация, годы 2000..2099 ----------
+
+static const uint8_t legacy_days_in_month[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+
+struct legacyDateTime
+{
+  uint8_t yOff, m, d, hh, mm, ss;
+
+  static uint16_t date2days(uint16_t y, uint8_t m, uint8_t d)
+  {
+    if (y >= 2000)
+      y -= 2000;
+    uint16_t days = d;
+    for (uint8_t i = 1; i < m; ++i)
+      days += legacy_days_in_month[i - 1];
+    if (m > 2 && y % 4 == 0)
+      ++days;
+    return days + 365 * y + (y + 3) / 4 - 1;
+  }
+
+  static long time2long(uint16_t days, uint8_t h, uint8_t m, uint8_t s)
+  {
+    return ((days * 24L + h) * 60 + m) * 60 + s;
+  }
+
+  legacyDateTime(uint32_t t)
+  {
+    t -= SECONDS_FROM_1970_TO_2000;
+
+    ss = t % 60;
+    t /= 60;
+    mm = t % 60;
+    t /= 60;
+    hh = t % 24;
+    uint16_t days = t / 24;
+    uint8_t leap;
+    for (yOff = 0;; ++yOff)
+    {
+      leap = yOff % 4 == 0;
+      if (days < 365u + leap)
+        break;
+      days -= 365 + leap;
+    }
+    for (m = 1;; ++m)
+    {
+      uint8_t daysPerMonth = legacy_days_in_month[m - 1];
+      if (leap && m == 2)
+        ++daysPerMonth;
+      if (days < daysPerMonth)
+        break;
+      days -= daysPerMonth;
+    }
+    d = days + 1;
+  }
+
+  uint32_t unixtime() const
+  {
+    uint16_t days = date2days(yOff, m, d);
+    return (time2long(days, hh, mm, ss) + SECONDS_FROM_1970_TO_2000);
+  }
+};
+
+// ---------------------------------------------------
+
+static const uint32_t COUNT = 1000000;
+static const uint32_t TIME_2100 = 4102444800ul; // 01.01.2100 00:00:00
+
+static uint32_t rnd_state = 2024;
+
+static uint32_t rnd()
+{
+  // xorshift32
+  rnd_state ^= rnd_state << 13;
+  rnd_state ^= rnd_state >> 17;
+  rnd_state ^= rnd_state << 5;
+  return (rnd_state);
+}
+
+template <class F>
+static double measure(F _f)
+{
+  auto start = std::chrono::steady_clock::now();
+  _f();
+  std::chrono::duration<double, std::nano> ns = std::chrono::steady_clock::now() - start;
+  return (ns.count() / COUNT);
+}
+
+static uint32_t *stamps;
+static volatile uint32_t sink;
+
+int main()
+{
+  int failures = 0;
+  stamps = new uint32_t[COUNT];
+
+  // сверка с gmtime(): весь интервал clkDateTime, 01.01.1970..07.02.2106
+  for (uint32_t i = 0; i < COUNT; i++)
+  {
+    uint32_t t = rnd();
+    time_t tt = t;
+    struct tm ref;
+    gmtime_r(&tt, &ref);
+    clkDateTime dt(t);
+    if (dt.year() != ref.tm_year + 1900 || dt.month() != ref.tm_mon + 1 || dt.day() != ref.tm_mday ||
+        dt.hour() != ref.tm_hour || dt.minute() != ref.tm_min || dt.second() != ref.tm_sec ||
+        dt.dayOfTheWeek() != ref.tm_wday || dt.unixtime() != t ||
+        clkDateTime(dt.year(), dt.month(), dt.day(), dt.hour(), dt.minute(), dt.second()).unixtime() != t)
+    {
+      if (failures++ < 10)
+      {
+        printf("  FAIL %lu: %04u-%02u-%02u %02u:%02u:%02u, gmtime %04d-%02d-%02d %02d:%02d:%02d\n",
+               (unsigned long)t, dt.year(), dt.month(), dt.day(), dt.hour(), dt.minute(), dt.second(),
+               ref.tm_year + 1900, ref.tm_mon + 1, ref.tm_mday, ref.tm_hour, ref.tm_min, ref.tm_sec);
+      }
+    }
+  }
+  printf("gmtime cross-check, 1970..2106: %lu timestamps, %d mismatches\n", (unsigned long)COUNT, failures);
+
+  // сравнение скорости на интервале прежней реализации, 2000..2099
+  for (uint32_t i = 0; i < COUNT; i++)
+  {
+    stamps[i] = SECONDS_FROM_1970_TO_2000 + rnd() % (TIME_2100 - SECONDS_FROM_1970_TO_2000);
+  }
+
+  int legacy_mismatches = 0;
+  for (uint32_t i = 0; i < COUNT; i++)
+  {
+    legacyDateTime old_dt(stamps[i]);
+    clkDateTime new_dt(stamps[i]);
+    if (old_dt.yOff + 2000 != new_dt.year() || old_dt.m != new_dt.month() || old_dt.d != new_dt.day() ||
+        old_dt.unixtime() != new_dt.unixtime())
+    {
+      legacy_mismatches++;
+    }
+  }
+  printf("legacy cross-check, 2000..2099: %d mismatches\n", legacy_mismatches);
+  failures += legacy_mismatches;
+
+  double old_from = measure([]
+                            { for (uint32_t i = 0; i < COUNT; i++) { legacyDateTime dt(stamps[i]); sink = dt.d; } });
+  double new_from = measure([]
+                            { for (uint32_t i = 0; i < COUNT; i++) { clkDateTime dt(stamps[i]); sink = dt.day(); } });
+  double old_to = measure([]
+                          { for (uint32_t i = 0; i < COUNT; i++) { legacyDateTime dt(stamps[i]); dt.ss = i % 60; sink = dt.unixtime(); } });
+  double new_to = measure([]
+                          { for (uint32_t i = 0; i < COUNT; i++) { clkDateTime dt(stamps[i]); sink = clkDateTime(dt.year(), dt.month(), dt.day(), dt.hour(), dt.minute(), i % 60).unixtime(); } });
+
+  printf("unixtime -> date:         legacy %6.1f ns, closed-form %6.1f ns\n", old_from, new_from);
+  printf("unixtime -> date -> unix: legacy %6.1f ns, closed-form %6.1f ns\n", old_to, new_to);
+
+  delete[] stamps;
+  printf("  %s\n", failures ? "FAILED" : "ok");
+  return (failures ? 1 : 0);
+}
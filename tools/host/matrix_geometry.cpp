@@ -0,0 +1,124 @@
+/*
+ * проверка размещения данных на матрице заданного размера: смещение блока
+ * данных, секундный столбик у правого края экрана и строка даты;
+ * собирается и запускается из tools/host/run.sh для нескольких размеров
+ * матрицы (MAX72xx, ширина и высота задаются в сгенерированном clockSetting.h)
+ */
+#include "clockSetting.h"
+#include <shSimpleClock.h>
+
+shSimpleClock clk;
+
+static int failures = 0;
+
+static void check(bool _ok, const char *_what, uint16_t _col)
+{
+  if (!_ok)
+  {
+    printf("  FAIL %s (column %u)\n", _what, _col);
+    failures++;
+  }
+}
+
+// цифра шрифта 6x8 в столбцах col..col+5
+static void checkDigit(uint16_t _col, uint8_t _digit, uint8_t _line, const char *_what)
+{
+  for (uint8_t i = 0; i < 6; i++)
+  {
+    check(clkDisplay.getColumn(_col + i, _line) == pgm_read_byte(&font_digit[_digit * 6 + i]), _what, _col + i);
+  }
+}
+
+// символ шрифта 5x7 в столбцах col..col+4
+static void checkChar(uint16_t _col, uint8_t _chr, uint8_t _line, const char *_what)
+{
+  for (uint8_t i = 0; i < 5; i++)
+  {
+    check(clkDisplay.getColumn(_col + i, _line) == reverseByte(pgm_read_byte(&font_5_7[_chr * 5 + i])), _what, _col + i);
+  }
+}
+
+static void checkEmpty(uint16_t _from, uint16_t _to, uint8_t _line, const char *_what)
+{
+  for (uint16_t i = _from; i < _to; i++)
+  {
+    check(clkDisplay.getColumn(i, _line) == 0, _what, i);
+  }
+}
+
+static void showTime(bool _second_column)
+{
+  clk.setSecondColumnState(_second_column);
+  sscBlinkFlag = false; // двоеточие выводится в первой половине секунды
+  sscShowTimeData(12, 34);
+  if (_second_column)
+  {
+    sscShowSecondColumn(clkClock.getCurTime().second());
+  }
+}
+
+static void checkLayout(bool _second_column)
+{
+  showTime(_second_column);
+
+  // при включенном секундном столбике данные сдвигаются на столбец влево
+  uint16_t x = MATRIX_DATA_OFFSET + (_second_column ? 0 : 1);
+
+  checkEmpty(0, x, 0, "left margin");
+  checkDigit(x, 1, 0, "hour tens");
+  checkDigit(x + 7, 2, 0, "hour ones");
+  check(clkDisplay.getColumn(x + 14, 0) == 0b00100100, "colon", x + 14);
+  checkDigit(x + 16, 3, 0, "minute tens");
+  checkDigit(x + 23, 4, 0, "minute ones");
+
+#if __USE_DATE_WITH_TIME__
+  // дата 25.05: число шрифтом 5x7, затем три буквы месяца
+  uint16_t d = x + MATRIX_DATE_OFFSET;
+  checkChar(d, '2', MATRIX_DATE_LINE, "day tens");
+  checkChar(d + 6, '5', MATRIX_DATE_LINE, "day ones");
+  for (uint8_t j = 0; j < 3; j++)
+  {
+    checkChar(d + 13 + j * 6, pgm_read_byte(&months[4 * 3 + j]), MATRIX_DATE_LINE, "month");
+  }
+  if (MATRIX_DATE_LINE > 0)
+  {
+    checkEmpty(x + 29, MATRIX_WIDTH - 1, 0, "time line right of the time");
+  }
+  checkEmpty(d + 31, MATRIX_WIDTH - 1, MATRIX_DATE_LINE, "date line right of the date");
+#else
+  checkEmpty(x + 29, MATRIX_WIDTH - 1, 0, "right margin");
+#endif
+
+  // 30 секунд - шесть светодиодов столбика
+  uint8_t sec = clkDisplay.getColumn(MATRIX_WIDTH - 1, 0);
+  if (_second_column)
+  {
+    check(sec == 0b01111110, "second column at the right edge", MATRIX_WIDTH - 1);
+  }
+  else
+  {
+    check(sec == 0, "right edge is empty", MATRIX_WIDTH - 1);
+  }
+}
+
+int main()
+{
+  clk.init();
+
+  // RTC: 12:34:30 25.05.2024
+  const uint8_t regs[] = {0x30, 0x34, 0x12, 0x06, 0x25, 0x05, 0x24};
+  memcpy(&Wire.regs[clkRtcChip::time_reg], regs, sizeof(regs));
+  clkClock.now();
+
+  printf("%ux%u (data offset %u", MATRIX_HEIGHT, MATRIX_WIDTH, MATRIX_DATA_OFFSET);
+#if __USE_DATE_WITH_TIME__
+  printf(", date at +%u, line %u", MATRIX_DATE_OFFSET, MATRIX_DATE_LINE);
+#endif
+  printf(")\n");
+
+  checkLayout(false);
+  checkLayout(true);
+
+  printf("  %s\n", failures ? "FAILED" : "ok");
+  return (failures ? 1 : 0);
+}
@@ -0,0 +1,67 @@
+#!/bin/sh
+# сборка и запуск проверок библиотеки на ПК:
+#
+#     sh tools/host/run.sh
+#
+# нужен компилятор C++17 (g++ или clang++, задается переменной CXX);
+# для каждой проверки из clockSetting.h в корне библиотеки создается свой
+# вариант настроек, ядро Arduino и сторонние библиотеки заменяются
+# заглушками из tools/host/stubs
+
+set -e
+
+HOST=$(cd "$(dirname "$0")" && pwd)
+ROOT=$(cd "$HOST/../.." && pwd)
+OUT=${OUT:-$ROOT/_host_build}
+CXX=${CXX:-g++}
+CXXFLAGS=${CXXFLAGS:--std=gnu++17 -O2 -Wall -Wno-unused-function -Wno-unused-variable -Wno-overflow}
+
+mkdir -p "$OUT"
+status=0
+
+# config <имя> <sed-выражение>... - clockSetting.h с изменениями в $OUT/<имя>
+config() {
+  name=$1
+  shift
+  mkdir -p "$OUT/$name"
+  cp "$ROOT/clockSetting.h" "$OUT/$name/clockSetting.h"
+  for e in "$@"; do
+    sed -i.bak "$e" "$OUT/$name/clockSetting.h"
+  done
+}
+
+# build <имя> <исходник> - сборка с настройками из $OUT/<имя>; Arduino.h
+# подключается первым, как это делает Arduino IDE для скетча
+build() {
+  $CXX $CXXFLAGS -include Arduino.h -I"$OUT/$1" -I"$HOST/stubs" -I"$ROOT/src" "$HOST/$2" -o "$OUT/$1/test"
+}
+
+MAX_MATRIX='s|^#define TM1637_DISPLAY|#define MAX72XX_MATRIX_DISPLAY|'
+CALENDAR='s|^// #define USE_CALENDAR|#define USE_CALENDAR|'
+SECOND_COLUMN='s|^// #define SHOW_SECOND_COLUMN|#define SHOW_SECOND_COLUMN|'
+
+# размещение данных на матрицах разного размера: высота x ширина
+for geometry in 8x32 16x32 8x48 8x64 16x64 8x96; do
+  h=${geometry%x*}
+  w=${geometry#*x}
+  config "matrix_$geometry" "$MAX_MATRIX" "$CALENDAR" "$SECOND_COLUMN" \
+    "s|^#define MATRIX_WIDTH 32|#define MATRIX_WIDTH $w|" \
+    "s|^#define MATRIX_HEIGHT 8|#define MATRIX_HEIGHT $h|"
+  build "matrix_$geometry" matrix_geometry.cpp
+  "$OUT/matrix_$geometry/test" || status=1
+done
+
+# преобразования даты в clkDateTime: сверка с gmtime() и сравнение с прежней реализацией
+config date_bench
+build date_bench date_bench.cpp
+"$OUT/date_bench/test" || status=1
+
+# трассировка задач: вывод dumpTaskTrace() разбирается утилитой tools/clktrace2json.py
+config trace "$MAX_MATRIX" 's|^// #define USE_TASK_TRACE|#define USE_TASK_TRACE|' \
+  's|^#define ADDITIONAL_TASK_COUNT 0|#define ADDITIONAL_TASK_COUNT 1|'
+build trace trace_dump.cpp
+"$OUT/trace/test" >"$OUT/trace/dump.txt" || status=1
+python3 "$ROOT/tools/clktrace2json.py" "$OUT/trace/dump.txt" -o "$OUT/trace/trace.json" || status=1
+python3 "$HOST/check_trace.py" "$OUT/trace/trace.json" || status=1
+
+exit $status
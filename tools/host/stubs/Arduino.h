@@ -0,0 +1,119 @@
+/*
+ * минимальная замена ядра Arduino для сборки библиотеки на ПК (см. tools/host/run.sh);
+ * время millis()/micros() не идет само, тест двигает его функцией host_advance()
+ */
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+#include <algorithm>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define PROGMEM
+#define pgm_read_byte(a) (*(const uint8_t *)(a))
+#define pgm_read_word(a) (*(const uint16_t *)(a))
+#define pgm_read_dword(a) (*(const uint32_t *)(a))
+#define pgm_read_ptr(a) (*(void *const *)(a))
+#define memcpy_P memcpy
+#define strlen_P strlen
+#define PSTR(s) (s)
+class __FlashStringHelper;
+#define F(s) ((const __FlashStringHelper *)(s))
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define A0 14
+#define A1 15
+#define A2 16
+#define A3 17
+#define A4 18
+#define A5 19
+#define A6 20
+#define A7 21
+#define DEC 10
+#define HEX 16
+
+#define lowByte(w) ((uint8_t)((w)&0xff))
+#define highByte(w) ((uint8_t)((w) >> 8))
+#define bitRead(v, b) (((v) >> (b)) & 0x01)
+#define bitSet(v, b) ((v) |= (1UL << (b)))
+#define bitClear(v, b) ((v) &= ~(1UL << (b)))
+#define bitWrite(v, b, x) ((x) ? bitSet(v, b) : bitClear(v, b))
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+#define interrupts()
+#define noInterrupts()
+
+using std::max;
+using std::min;
+
+inline uint32_t host_micros = 0;
+
+inline void host_advance(uint32_t _us) { host_micros += _us; }
+
+inline unsigned long micros() { return (host_micros); }
+inline unsigned long millis() { return (host_micros / 1000ul); }
+inline void delay(unsigned long _ms) { host_advance(_ms * 1000ul); }
+inline void delayMicroseconds(unsigned int _us) { host_advance(_us); }
+inline void yield() {}
+
+inline void pinMode(uint8_t, uint8_t) {}
+inline void digitalWrite(uint8_t, uint8_t) {}
+inline int digitalRead(uint8_t) { return (HIGH); } // кнопки с подтяжкой к VCC не нажаты
+inline int analogRead(uint8_t) { return (0); }
+inline void tone(uint8_t, unsigned int, unsigned long = 0) {}
+inline void noTone(uint8_t) {}
+
+class Print
+{
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t) = 0;
+
+  size_t print(const char *_s)
+  {
+    size_t n = 0;
+    while (*_s)
+    {
+      n += write((uint8_t)*_s++);
+    }
+    return (n);
+  }
+  size_t print(const __FlashStringHelper *_s) { return (print((const char *)_s)); }
+  size_t print(char _c) { return (write((uint8_t)_c)); }
+  size_t print(long _n, int = DEC)
+  {
+    char buf[24];
+    snprintf(buf, sizeof(buf), "%ld", _n);
+    return (print(buf));
+  }
+  size_t print(unsigned long _n, int = DEC)
+  {
+    char buf[24];
+    snprintf(buf, sizeof(buf), "%lu", _n);
+    return (print(buf));
+  }
+  size_t print(int _n, int _base = DEC) { return (print((long)_n, _base)); }
+  size_t print(unsigned int _n, int _base = DEC) { return (print((unsigned long)_n, _base)); }
+  size_t println() { return (print('\n')); }
+  template <class T>
+  size_t println(T _v) { return (print(_v) + println()); }
+};
+
+class HardwareSerial : public Print
+{
+public:
+  void begin(unsigned long) {}
+  int available() { return (0); }
+  int read() { return (-1); }
+  size_t write(uint8_t _c) override { return (fputc(_c, stdout) == EOF ? 0 : 1); }
+};
+
+inline HardwareSerial Serial;
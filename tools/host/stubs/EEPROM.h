@@ -0,0 +1,37 @@
+/*
+ * EEPROM в оперативной памяти; после первого включения все ячейки равны 0xFF
+ */
+#pragma once
+#include <Arduino.h>
+
+class EEPROMClass
+{
+private:
+  uint8_t data[1024];
+
+public:
+  EEPROMClass() { memset(data, 0xFF, sizeof(data)); }
+
+  uint8_t read(int _index) { return (data[_index]); }
+  void write(int _index, uint8_t _value) { data[_index] = _value; }
+  void update(int _index, uint8_t _value) { data[_index] = _value; }
+  uint16_t length() { return (sizeof(data)); }
+  void begin(size_t) {}
+  bool commit() { return (true); }
+
+  template <class T>
+  T &get(int _index, T &_t)
+  {
+    memcpy(&_t, &data[_index], sizeof(T));
+    return (_t);
+  }
+
+  template <class T>
+  const T &put(int _index, const T &_t)
+  {
+    memcpy(&data[_index], &_t, sizeof(T));
+    return (_t);
+  }
+};
+
+inline EEPROMClass EEPROM;
@@ -0,0 +1,51 @@
+/*
+ * шина I2C с одним устройством - набором из 32 регистров, как у DS3231:
+ * первый байт после beginTransmission() задает номер регистра, следующие
+ * записываются в регистры подряд; чтение идет с текущего регистра
+ */
+#pragma once
+#include <Arduino.h>
+
+class TwoWire
+{
+private:
+  bool set_pointer = false;
+
+public:
+  uint8_t regs[32] = {0};
+  uint8_t pointer = 0;
+
+  void begin() {}
+  void setClock(uint32_t) {}
+  void beginTransmission(uint8_t) { set_pointer = true; }
+  uint8_t endTransmission(bool = true) { return (0); }
+
+  size_t write(uint8_t _data)
+  {
+    if (set_pointer)
+    {
+      pointer = _data;
+      set_pointer = false;
+    }
+    else
+    {
+      regs[pointer++ % sizeof(regs)] = _data;
+    }
+    return (1);
+  }
+  size_t write(const uint8_t *_data, size_t _count)
+  {
+    for (size_t i = 0; i < _count; i++)
+    {
+      write(_data[i]);
+    }
+    return (_count);
+  }
+
+  uint8_t requestFrom(int, int _count) { return ((uint8_t)_count); }
+  uint8_t requestFrom(uint8_t, uint8_t _count, uint8_t = 1) { return (_count); }
+  int available() { return (1); }
+  int read() { return (regs[pointer++ % sizeof(regs)]); }
+};
+
+inline TwoWire Wire;
@@ -0,0 +1,37 @@
+/*
+ * модули MAX72xx без SPI: столбцы только хранятся в буфере, чтобы тест мог
+ * прочитать изображение обратно
+ */
+#pragma once
+#include <Arduino.h>
+
+template <uint8_t cs_pin, uint8_t num_devices>
+class shMAX72xxMini
+{
+private:
+  uint8_t buf[num_devices][8];
+
+public:
+  shMAX72xxMini() { clearAllDevices(); }
+
+  void init() {}
+  void shutdownAllDevices(bool) {}
+  void setBrightness(uint8_t, uint8_t) {}
+  void setDirection(uint8_t) {}
+  void setFlip(bool) {}
+  void update() {}
+  void clearDevice(uint8_t _addr, bool = false) { memset(buf[_addr], 0, 8); }
+  void clearAllDevices(bool = false) { memset(buf, 0, sizeof(buf)); }
+  void setColumn(uint8_t _addr, uint8_t _col, uint8_t _value) { buf[_addr][_col] = _value; }
+  uint8_t getColumn(uint8_t _addr, uint8_t _col) { return (buf[_addr][_col]); }
+  void setRow(uint8_t, uint8_t, uint8_t) {}
+  void setLed(uint8_t, uint8_t, uint8_t, bool) {}
+};
+
+template <uint8_t cs_pin, uint8_t num_devices, uint8_t num_digits>
+class shMAX72xx7Segment : public shMAX72xxMini<cs_pin, num_devices>
+{
+public:
+  void setChar(uint8_t, uint8_t, bool = false) {}
+  void setDigit(uint8_t, uint8_t, bool = false) {}
+};
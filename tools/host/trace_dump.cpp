@@ -0,0 +1,62 @@
+/*
+ * трассировка задач: часы работают несколько секунд модельного времени, вывод
+ * dumpTaskTrace() печатается в stdout вместе с посторонними строками, как его
+ * сохранил бы монитор порта; run.sh передает этот вывод утилите
+ * tools/clktrace2json.py и проверяет полученный JSON
+ */
+#include "clockSetting.h"
+#include <shSimpleClock.h>
+#include <string>
+
+shSimpleClock clk;
+
+static const uint32_t WORK_TIME = 2000; // время работы пользовательской задачи, мкс
+
+// пользовательская задача, которая заметно занимает процессор
+void sensorTask() { host_advance(WORK_TIME); }
+
+// вывод, сохраняемый в строку
+class StringPrint : public Print
+{
+public:
+  std::string text;
+
+  size_t write(uint8_t _c) override
+  {
+    text += (char)_c;
+    return (1);
+  }
+};
+
+int main()
+{
+  clk.init();
+  clkHandle sensor = clk.addAdditionalTask(100ul, sensorTask);
+
+  // 3 секунды с вызовом tick() раз в миллисекунду
+  for (uint16_t i = 0; i < 3000; i++)
+  {
+    clk.tick();
+    host_advance(1000);
+  }
+
+  StringPrint dump;
+  clk.dumpTaskTrace(dump);
+
+  // вывод скетча до дампа и отладочная строка, попавшая в середину дампа
+  printf("sketch started, sensor task %d\n", sensor);
+  uint16_t records = 0;
+  size_t pos = 0;
+  while (pos < dump.text.size())
+  {
+    size_t eol = dump.text.find('\n', pos);
+    std::string line = dump.text.substr(pos, eol - pos);
+    pos = eol + 1;
+    printf("%s\n", line.c_str());
+    if (!line.empty() && line[0] != '#' && line[0] != '@' && ++records == 3)
+    {
+      printf("sensor: 23.5 C\n");
+    }
+  }
+  return (sensor != CLK_INVALID_HANDLE && records == TRACE_BUFFER_SIZE ? 0 : 1);
+}